@@ -0,0 +1,31 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_ALLOCATIONCOUNTER_HPP
+#define WR_ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+namespace WGPURenderer {
+    // Counts the heap allocations made through the global operator new, which the program replaces. Allocations
+    // made by C libraries with malloc, such as the WebGPU implementation, aren't counted.
+    class AllocationCounter {
+    public:
+        AllocationCounter() = delete;
+        ~AllocationCounter() = delete;
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter(AllocationCounter&&) = delete;
+
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(AllocationCounter&&) = delete;
+
+        // Allocations of the calling thread since it started.
+        static uint64_t GetThreadAllocationCount();
+    };
+}
+
+#endif // WR_ALLOCATIONCOUNTER_HPP
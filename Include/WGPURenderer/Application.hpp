@@ -7,14 +7,32 @@
 #ifndef WR_APPLICATION_HPP
 #define WR_APPLICATION_HPP
 
+#include <WGPURenderer/ApplicationConfig.hpp>
+#include <WGPURenderer/Benchmark.hpp>
+#include <WGPURenderer/FrameContext.hpp>
+#include <WGPURenderer/FrameRing.hpp>
+#include <WGPURenderer/Geometry.hpp>
+#include <WGPURenderer/GpuTimer.hpp>
+#include <WGPURenderer/IndirectDraw.hpp>
+#include <WGPURenderer/InstanceBuffer.hpp>
+#include <WGPURenderer/MeshPool.hpp>
+#include <WGPURenderer/ResourceRegistry.hpp>
+#include <WGPURenderer/StagingBelt.hpp>
+#include <WGPURenderer/UniformRing.hpp>
+
 #include <GLFW/glfw3.h>
 
 #include <webgpu/webgpu.hpp>
 
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <string>
+
 namespace WGPURenderer {
     class Application {
     public:
-        Application() = default;
+        explicit Application(ApplicationConfig config = {});
         ~Application() = default;
 
         Application(const Application&) = delete;
@@ -26,20 +44,65 @@ namespace WGPURenderer {
         bool Run();
     
     private:
+        ApplicationConfig m_Config;
+        std::string m_AdapterName;
+        std::string m_BackendName;
         GLFWwindow* m_Window = nullptr;
         wgpu::Surface m_Surface = nullptr;
+        // Kept to reconfigure the surface when the window is resized.
+        wgpu::SurfaceConfiguration m_SurfaceConfiguration{};
+        // Framebuffer size reported by the last resize event. Resizes are only applied once per frame, so that the
+        // many events of a window drag only reconfigure the surface once.
+        uint32_t m_FramebufferWidth = 0;
+        uint32_t m_FramebufferHeight = 0;
+        bool m_SurfaceResizePending = false;
+        // Render target of headless runs, in place of the surface.
+        TextureHandle m_OffscreenTexture;
         wgpu::TextureFormat m_SurfaceFormat = wgpu::TextureFormat::Undefined;
+        // Size of the surface as configured, or of the offscreen target.
+        uint32_t m_TargetWidth = 0;
+        uint32_t m_TargetHeight = 0;
+        wgpu::PresentMode m_PresentMode = wgpu::PresentMode::Fifo;
         wgpu::Device m_Device = nullptr;
         wgpu::Queue m_Queue = nullptr;
         std::unique_ptr<wgpu::ErrorCallback> m_UncapturedErrorCallbackHandle = nullptr;
-        wgpu::Buffer m_PointBuffer = nullptr;
-        wgpu::Buffer m_IndexBuffer = nullptr;
-        uint32_t m_IndexCount = 0;
-        wgpu::RenderPipeline m_Pipeline = nullptr;
+        // Owns the GPU objects that the application creates directly.
+        ResourceRegistry m_Resources;
+        MeshPool m_MeshPool;
+        MeshHandle m_Mesh = InvalidMesh;
+        VertexEncoding m_VertexEncoding = VertexEncoding::Float;
+        VertexLayout m_VertexLayout;
+        StagingBelt m_StagingBelt;
+        InstanceBuffer m_Instances;
+        IndirectDraw m_IndirectDraw;
+        // Bounding radius of the mesh around its origin once the object offset is applied, for culling.
+        float m_MeshRadius = 0.0f;
+        BufferHandle m_MeshUniformBuffer;
+        BufferHandle m_ViewUniformBuffer;
+        BindGroupHandle m_MeshBindGroup;
+        UniformRing m_UniformRing;
+        BindGroupHandle m_ObjectBindGroup;
+        RenderPipelineHandle m_Pipeline;
+        FrameContext m_FrameContext;
+        FrameRing m_FrameRing;
+        GpuTimer m_GpuTimer;
+
+        std::chrono::steady_clock::time_point m_StartTime;
+        bool m_FirstFrameRendered = false;
+        // Written by the loading thread, only read once m_AssetsLoaded is ready.
+        Geometry m_Geometry;
+        double m_AssetLoadTime = 0.0;
+        // Declared after what the loading thread writes, so that destroying it waits for the thread first.
+        std::future<bool> m_AssetsLoaded;
         
+        void StartLoadingAssets();
+
         bool Initialize();
 
-        void MainLoop();
+        // Renders the configured frames, then reports the benchmark if enabled. Returns false if it failed.
+        bool RenderFrames(const std::filesystem::path& reportPath);
+
+        void MainLoop(FrameTimings& timings);
 
         void Terminate();
 
@@ -47,7 +110,32 @@ namespace WGPURenderer {
 
         bool InitializeBuffers();
 
-        wgpu::TextureView GetNextSurfaceTextureView();
+        // Lays the instances out on a square grid, a single instance being drawn as is.
+        void InitializeInstances(uint32_t instanceCount);
+
+        wgpu::Texture GetNextSurfaceTexture();
+
+        // Applies the pending resize, if any. Returns false while the window is minimized.
+        bool UpdateSurfaceSize();
+
+        // Only the surface's textures change, the pipeline stays valid since the format doesn't.
+        void ReconfigureSurface();
+
+        void UpdateViewUniforms();
+
+        static void OnFramebufferResized(GLFWwindow* window, int width, int height);
+
+        // The configured present mode if the surface supports it, Fifo otherwise.
+        wgpu::PresentMode SelectPresentMode(wgpu::Adapter adapter);
+
+        bool InitializeOffscreenTarget();
+
+        // Reads the offscreen target back and writes it as an image.
+        bool SaveOffscreenTarget(const std::filesystem::path& path);
+
+        bool ReportBenchmark(const Benchmark& benchmark, const std::filesystem::path& reportPath) const;
+
+        static double GetElapsedMilliseconds(std::chrono::steady_clock::time_point start);
     };
 }
 
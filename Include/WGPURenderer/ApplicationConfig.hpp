@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_APPLICATIONCONFIG_HPP
+#define WR_APPLICATIONCONFIG_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace WGPURenderer {
+    enum class DrawMode : uint8_t {
+        Direct,     // drawIndexed with the instance count known by the CPU.
+        Indirect,   // drawIndexedIndirect with arguments written by the CPU.
+        GpuCulling, // drawIndexedIndirect with arguments written by a culling compute pass.
+    };
+
+    struct ApplicationConfig {
+        uint32_t width = 640;
+        uint32_t height = 480;
+
+        // Renders into an offscreen texture instead of a window, for machines without a display.
+        bool headless = false;
+        // Number of frames to render before exiting, or of measured frames in benchmark mode. 0 picks the default
+        // of the mode, see GetFrameCount().
+        uint32_t frameCount = 0;
+        // Headless only: the last frame is read back and written there, as a .ppm or .png image.
+        std::filesystem::path outputPath;
+
+        // Renders `warmupFrameCount` frames, then measures `frameCount` frames and prints their statistics.
+        bool benchmark = false;
+        uint32_t warmupFrameCount = 60;
+        // Benchmark only: JSON report of the run, for regression tracking.
+        std::filesystem::path reportPath;
+        // Benchmark only: fails the run if a measured frame allocated from the heap on the main thread.
+        bool requireNoAllocations = false;
+
+        // Asks for a software adapter, such as lavapipe.
+        bool forceFallbackAdapter = false;
+
+        // Reuses the view of the offscreen target across frames in headless mode, surface textures always get a new
+        // view. Disabling it creates a view for every frame, to measure what the cache saves in benchmark mode.
+        bool cacheTargetViews = true;
+
+        // Frames the CPU may record ahead of the GPU, from 1 to FrameRing::MaxFramesInFlight.
+        uint32_t framesInFlight = 2;
+
+        // Falls back to Fifo, which every surface supports, when the surface doesn't support it.
+        wgpu::PresentMode presentMode = wgpu::PresentMode::Fifo;
+        // Caps the frame rate on the CPU, mostly useful with Mailbox and Immediate. 0 doesn't limit it.
+        uint32_t maxFrameRate = 0;
+        // Copies of the mesh drawn with a single instanced draw call, laid out on a grid.
+        uint32_t instanceCount = 1;
+        // Benchmark only: instance counts measured one after the other in place of `instanceCount`, each with its
+        // warmup. Their reports are named after the count.
+        std::vector<uint32_t> instanceSweep;
+        DrawMode drawMode = DrawMode::Direct;
+        // KiB that the staging belt uploads per frame at most, 0 for no limit. Uploads past it wait for later frames.
+        uint32_t uploadBudget = 0;
+
+        // Waits for the GPU to finish the previous frame before polling the input, so that each frame reacts to the
+        // most recent input, at the cost of CPU/GPU overlap.
+        bool lowLatency = false;
+
+        // Worker threads of the job system, 0 for one per hardware thread besides the main thread.
+        uint32_t workerCount = 0;
+
+        // Builds with the `profiling` option write the Chrome trace of the run there.
+        std::filesystem::path tracePath = "trace.json";
+
+        static constexpr uint32_t DefaultBenchmarkFrameCount = 600;
+
+        // 0 when frames are rendered until the window is closed.
+        [[nodiscard]] uint32_t GetFrameCount() const;
+
+        // Prints the usage and returns false on invalid arguments or when the usage was asked for.
+        static bool ParseCommandLine(int argc, const char* const* argv, ApplicationConfig& config);
+
+        static void PrintUsage(const char* programName);
+    };
+}
+
+#endif // WR_APPLICATIONCONFIG_HPP
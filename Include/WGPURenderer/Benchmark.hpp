@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_BENCHMARK_HPP
+#define WR_BENCHMARK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace WGPURenderer {
+    // CPU time spent in each phase of a frame, in milliseconds.
+    struct FrameTimings {
+        double pacing = 0.0;  // Frame limiter and low latency waits, before the input is polled.
+        double wait = 0.0;    // Waiting for the GPU to free a frame slot.
+        double acquire = 0.0; // Getting the target texture view.
+        double encode = 0.0;  // Recording the command buffer.
+        double submit = 0.0;
+        double present = 0.0; // Presenting and polling the device.
+        double frame = 0.0;   // Wall time of the whole frame, events included.
+
+        // Frames the GPU hadn't finished yet when this one started recording.
+        uint32_t inFlightCount = 0;
+        // Calls to operator new on the main thread during the frame.
+        uint32_t heapAllocationCount = 0;
+    };
+
+    struct TimingStatistics {
+        double min = 0.0;
+        double mean = 0.0;
+        double median = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    // Describes the run in the report, so that results from different machines aren't mixed up.
+    struct BenchmarkInfo {
+        std::string adapterName;
+        std::string backendName;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool headless = false;
+        uint32_t warmupFrameCount = 0;
+        bool gpuTimestamps = false;
+        bool targetViewCache = true;
+        uint32_t framesInFlight = 0;
+        std::string presentMode;
+        uint32_t maxFrameRate = 0;
+        bool lowLatency = false;
+        uint32_t instanceCount = 0;
+        std::string drawMode;
+    };
+
+    class Benchmark {
+    public:
+        explicit Benchmark(size_t expectedFrameCount);
+        ~Benchmark() = default;
+
+        Benchmark(const Benchmark&) = delete;
+        Benchmark(Benchmark&&) = delete;
+
+        Benchmark& operator=(const Benchmark&) = delete;
+        Benchmark& operator=(Benchmark&&) = delete;
+
+        void AddFrame(const FrameTimings& timings);
+
+        // GPU time of a measured frame, in milliseconds. Only the frames that could be timed are added, and they
+        // arrive a few frames late.
+        void AddGpuFrame(double duration);
+
+        // Wall time of the measured frames, including the wait for the GPU to finish them.
+        void SetTotalTime(double totalTime);
+
+        [[nodiscard]] size_t GetFrameCount() const;
+        [[nodiscard]] uint32_t GetMaxHeapAllocationCount() const;
+
+        void PrintSummary() const;
+
+        bool WriteReport(const std::filesystem::path& path, const BenchmarkInfo& info) const;
+
+        // Percentiles use the nearest-rank method.
+        static TimingStatistics ComputeStatistics(std::span<const double> samples);
+
+    private:
+        std::vector<FrameTimings> m_Frames;
+        std::vector<double> m_GpuFrameTimes;
+        double m_TotalTime = 0.0;
+
+        [[nodiscard]] double GetAverageFps() const;
+
+        [[nodiscard]] TimingStatistics ComputeStatistics(double FrameTimings::* metric) const;
+
+        [[nodiscard]] TimingStatistics ComputeStatistics(uint32_t FrameTimings::* count) const;
+    };
+}
+
+#endif // WR_BENCHMARK_HPP
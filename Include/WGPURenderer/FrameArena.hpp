@@ -0,0 +1,103 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_FRAMEARENA_HPP
+#define WR_FRAMEARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace WGPURenderer {
+    // Bump allocator for transient data, released all at once by Reset() instead of one allocation at a time.
+    // Containers use it through std::pmr, e.g. std::pmr::vector<T> values(&arena). Deallocating does nothing: the
+    // memory comes back on the next Reset(), or when leaving a Scope. Once it has grown to the peak usage, an arena
+    // that is reset every frame never touches the heap again.
+    class FrameArena final : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+        // Rewinds the arena to where it was on construction, freeing what was allocated in between.
+        class Scope {
+        public:
+            explicit Scope(FrameArena& arena)
+                : m_Arena(arena), m_Block(arena.m_CurrentBlock), m_Offset(arena.m_Offset),
+                  m_UsedBeforeBlock(arena.m_UsedBeforeCurrentBlock) {
+            }
+
+            ~Scope() {
+                m_Arena.m_CurrentBlock = m_Block;
+                m_Arena.m_Offset = m_Offset;
+                m_Arena.m_UsedBeforeCurrentBlock = m_UsedBeforeBlock;
+            }
+
+            Scope(const Scope&) = delete;
+            Scope(Scope&&) = delete;
+
+            Scope& operator=(const Scope&) = delete;
+            Scope& operator=(Scope&&) = delete;
+
+        private:
+            FrameArena& m_Arena;
+            size_t m_Block;
+            size_t m_Offset;
+            size_t m_UsedBeforeBlock;
+        };
+
+        explicit FrameArena(size_t blockSize = DefaultBlockSize);
+        ~FrameArena() override = default;
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena(FrameArena&&) = delete;
+
+        FrameArena& operator=(const FrameArena&) = delete;
+        FrameArena& operator=(FrameArena&&) = delete;
+
+        // Frees everything. If the last use needed several blocks, they are replaced by a single one large enough
+        // for all of them.
+        void Reset();
+
+        // Allocations since the last reset.
+        [[nodiscard]] uint64_t GetAllocationCount() const;
+        // Bytes allocated since the last reset, alignment included.
+        [[nodiscard]] size_t GetUsedSize() const;
+        [[nodiscard]] size_t GetPeakUsedSize() const;
+        [[nodiscard]] size_t GetCapacity() const;
+        // Blocks allocated from the heap over the arena's lifetime.
+        [[nodiscard]] uint64_t GetBlockAllocationCount() const;
+
+        // Arena of the calling thread, for the transient data of workers. The thread resets it or scopes its uses.
+        static FrameArena& GetThreadArena();
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            size_t size = 0;
+        };
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void AddBlock(size_t size);
+        // Returns nullptr if the current block doesn't have room for the allocation.
+        void* AllocateFromCurrentBlock(size_t bytes, size_t alignment);
+
+        std::vector<Block> m_Blocks;
+        size_t m_BlockSize;
+        size_t m_CurrentBlock = 0;
+        size_t m_Offset = 0;
+        // Size of the blocks before the current one, which are full or were skipped.
+        size_t m_UsedBeforeCurrentBlock = 0;
+        size_t m_PeakUsedSize = 0;
+        uint64_t m_AllocationCount = 0;
+        uint64_t m_BlockAllocationCount = 0;
+    };
+}
+
+#endif // WR_FRAMEARENA_HPP
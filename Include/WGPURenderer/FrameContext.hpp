@@ -0,0 +1,66 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_FRAMECONTEXT_HPP
+#define WR_FRAMECONTEXT_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstdint>
+
+namespace WGPURenderer {
+    // Holds what recording a frame needs and that doesn't change from a frame to the next: the descriptors are built
+    // once and only their per-frame fields are patched, and the view of a render target that outlives the frames is
+    // kept from a frame to the next.
+    class FrameContext {
+    public:
+        FrameContext();
+        ~FrameContext() = default;
+
+        FrameContext(const FrameContext&) = delete;
+        FrameContext(FrameContext&&) = delete;
+
+        FrameContext& operator=(const FrameContext&) = delete;
+        FrameContext& operator=(FrameContext&&) = delete;
+
+        // Caching keeps the view of the last target until another texture is acquired, so it only pays off for a
+        // target that is the same texture every frame. Surface textures are new objects every frame, even when the
+        // swapchain image is the same. Without caching, a view is created for every frame and released by
+        // ReleaseTargetView().
+        void Initialize(wgpu::TextureFormat targetFormat, bool cacheViews);
+        // Releases the cached view, e.g. before its texture is destroyed.
+        void Reset();
+
+        // View of the frame's render target, nullptr on failure.
+        [[nodiscard]] wgpu::TextureView AcquireTargetView(wgpu::Texture texture);
+        void ReleaseTargetView(wgpu::TextureView view);
+
+        [[nodiscard]] const wgpu::CommandEncoderDescriptor& GetEncoderDescriptor() const;
+        [[nodiscard]] const wgpu::RenderPassDescriptor& GetRenderPassDescriptor(
+            wgpu::TextureView targetView, const wgpu::RenderPassTimestampWrites* timestampWrites);
+        [[nodiscard]] const wgpu::CommandBufferDescriptor& GetCommandBufferDescriptor() const;
+
+        [[nodiscard]] bool IsViewCacheEnabled() const;
+        [[nodiscard]] uint64_t GetViewCacheHitCount() const;
+        [[nodiscard]] uint64_t GetViewCacheMissCount() const;
+
+    private:
+        wgpu::CommandEncoderDescriptor m_EncoderDesc{};
+        wgpu::RenderPassColorAttachment m_ColorAttachment{};
+        wgpu::RenderPassDescriptor m_RenderPassDesc{};
+        wgpu::CommandBufferDescriptor m_CommandBufferDesc{};
+        wgpu::TextureViewDescriptor m_ViewDesc{};
+
+        bool m_CacheViews = true;
+        // Holds a reference on the texture, so that its handle can't be reused by another texture while cached.
+        wgpu::Texture m_CachedTexture = nullptr;
+        wgpu::TextureView m_CachedView = nullptr;
+        uint64_t m_HitCount = 0;
+        uint64_t m_MissCount = 0;
+    };
+}
+
+#endif // WR_FRAMECONTEXT_HPP
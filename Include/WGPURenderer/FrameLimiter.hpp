@@ -0,0 +1,43 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_FRAMELIMITER_HPP
+#define WR_FRAMELIMITER_HPP
+
+#include <chrono>
+
+namespace WGPURenderer {
+    // Caps the frame rate on the CPU side, for present modes that don't wait for the display. Frames start on a
+    // fixed schedule: a late frame doesn't make the next ones start early to catch up, the schedule restarts from it.
+    class FrameLimiter {
+    public:
+        // A frame rate of 0 doesn't limit anything.
+        explicit FrameLimiter(double maxFrameRate);
+        ~FrameLimiter() = default;
+
+        FrameLimiter(const FrameLimiter&) = delete;
+        FrameLimiter(FrameLimiter&&) = delete;
+
+        FrameLimiter& operator=(const FrameLimiter&) = delete;
+        FrameLimiter& operator=(FrameLimiter&&) = delete;
+
+        // Waits until the next frame may start.
+        void Wait();
+
+        [[nodiscard]] bool IsEnabled() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // Sleeping is only accurate to a millisecond or so on most systems, the end of the wait spins.
+        static constexpr Clock::duration SpinDuration = std::chrono::microseconds(1500);
+
+        Clock::duration m_FramePeriod{};
+        Clock::time_point m_NextFrameStart{};
+    };
+}
+
+#endif // WR_FRAMELIMITER_HPP
@@ -0,0 +1,68 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_FRAMERING_HPP
+#define WR_FRAMERING_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace WGPURenderer {
+    // Bounds how many frames the CPU records ahead of the GPU. Each frame in flight owns a slot of the ring, whose
+    // completion is tracked with the queue's work done callback. A slot is only handed out again once the GPU
+    // finished its previous frame, so that the resources the CPU writes per frame can be indexed by slot and reused
+    // without any other synchronization.
+    class FrameRing {
+    public:
+        static constexpr uint32_t MaxFramesInFlight = 3;
+
+        FrameRing() = default;
+        ~FrameRing() = default;
+
+        FrameRing(const FrameRing&) = delete;
+        FrameRing(FrameRing&&) = delete;
+
+        FrameRing& operator=(const FrameRing&) = delete;
+        FrameRing& operator=(FrameRing&&) = delete;
+
+        // `framesInFlight` is clamped to [1, MaxFramesInFlight].
+        void Initialize(wgpu::Device device, wgpu::Queue queue, uint32_t framesInFlight);
+        // Waits for every frame in flight.
+        void Terminate();
+
+        // Waits until the GPU is done with the previous frame of the next slot and returns the index of that slot.
+        uint32_t BeginFrame();
+        // Starts tracking the frame, once it was submitted with Queue::submitForIndex().
+        void EndFrame(wgpu::SubmissionIndex submissionIndex);
+
+        // Waits until the GPU finished every frame submitted so far.
+        void WaitForAll();
+
+        [[nodiscard]] uint32_t GetFramesInFlight() const;
+        // Frames submitted that the GPU hasn't finished yet, as of the last device poll.
+        [[nodiscard]] uint32_t GetInFlightCount() const;
+
+    private:
+        struct Slot {
+            bool inFlight = false;
+            wgpu::SubmissionIndex submissionIndex = 0;
+        };
+
+        static void OnWorkDone(WGPUQueueWorkDoneStatus status, void* userdata);
+
+        void WaitForSlot(Slot& slot);
+
+        wgpu::Device m_Device = nullptr;
+        wgpu::Queue m_Queue = nullptr;
+        std::array<Slot, MaxFramesInFlight> m_Slots;
+        uint32_t m_FramesInFlight = 1;
+        uint32_t m_CurrentSlot = 0;
+    };
+}
+
+#endif // WR_FRAMERING_HPP
@@ -0,0 +1,81 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_GEOMETRY_HPP
+#define WR_GEOMETRY_HPP
+
+#include <WGPURenderer/MappedFile.hpp>
+#include <WGPURenderer/VertexLayout.hpp>
+
+#include <webgpu/webgpu.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace WGPURenderer {
+    // Maps the positions stored in the vertex buffer back to model units: position * scale + offset.
+    struct PositionTransform {
+        std::array<float, 3> scale = {1.0f, 1.0f, 1.0f};
+        std::array<float, 3> offset = {0.0f, 0.0f, 0.0f};
+    };
+
+    // Vertex and index data of a mesh, either owned or viewed straight from a mapped geometry cache.
+    class Geometry {
+    public:
+        Geometry() = default;
+        ~Geometry() = default;
+
+        Geometry(const Geometry&) = delete;
+        Geometry(Geometry&&) = default;
+
+        Geometry& operator=(const Geometry&) = delete;
+        Geometry& operator=(Geometry&&) = default;
+
+        void SetVertices(std::vector<std::byte>&& vertexData, const VertexLayout& layout, VertexEncoding encoding);
+        // Indices are stored as 16-bit whenever they all fit, to keep the bandwidth down.
+        void SetIndices(std::vector<uint32_t>&& indexData);
+
+        // Views into `storage`, which is kept alive as long as the geometry.
+        void SetStorage(MappedFile&& storage);
+        void SetVertices(std::span<const std::byte> vertexData, const VertexLayout& layout, VertexEncoding encoding);
+        void SetIndices(std::span<const std::byte> indexData, wgpu::IndexFormat indexFormat);
+
+        void SetPositionTransform(const PositionTransform& transform);
+
+        [[nodiscard]] std::span<const std::byte> GetVertexData() const;
+        [[nodiscard]] const VertexLayout& GetVertexLayout() const;
+        [[nodiscard]] VertexEncoding GetVertexEncoding() const;
+        [[nodiscard]] size_t GetVertexStride() const;
+        [[nodiscard]] size_t GetVertexCount() const;
+        [[nodiscard]] const PositionTransform& GetPositionTransform() const;
+
+        [[nodiscard]] std::span<const std::byte> GetIndexData() const;
+        [[nodiscard]] wgpu::IndexFormat GetIndexFormat() const;
+        [[nodiscard]] size_t GetIndexCount() const;
+
+        // Buffer uploads must be a multiple of 4 bytes, the index storage is padded so that this size is readable.
+        [[nodiscard]] size_t GetIndexUploadSize() const;
+
+        static size_t GetIndexSize(wgpu::IndexFormat indexFormat);
+
+    private:
+        MappedFile m_Storage;
+        std::vector<std::byte> m_VertexStorage;
+        std::vector<uint16_t> m_ShortIndexStorage;
+        std::vector<uint32_t> m_IndexStorage;
+        std::span<const std::byte> m_VertexData;
+        std::span<const std::byte> m_IndexData;
+        VertexLayout m_VertexLayout;
+        VertexEncoding m_VertexEncoding = VertexEncoding::Float;
+        wgpu::IndexFormat m_IndexFormat = wgpu::IndexFormat::Undefined;
+        PositionTransform m_PositionTransform;
+    };
+}
+
+#endif // WR_GEOMETRY_HPP
@@ -0,0 +1,50 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_GEOMETRYCACHE_HPP
+#define WR_GEOMETRYCACHE_HPP
+
+#include <WGPURenderer/Geometry.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace WGPURenderer {
+    // Binary sidecar of a text model, holding its parsed vertex and index blobs ready to be mapped and uploaded.
+    class GeometryCache {
+    public:
+        struct SourceStamp {
+            uint64_t size;
+            int64_t writeTime;
+        };
+
+        GeometryCache() = delete;
+        ~GeometryCache() = delete;
+
+        GeometryCache(const GeometryCache&) = delete;
+        GeometryCache(GeometryCache&&) = delete;
+
+        GeometryCache& operator=(const GeometryCache&) = delete;
+        GeometryCache& operator=(GeometryCache&&) = delete;
+
+        static std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath);
+        static bool GetSourceStamp(const std::filesystem::path& sourcePath, SourceStamp& stamp);
+
+        // Fails when there is no cache for `sourcePath`, when it no longer matches the source file or when it was
+        // built with another vertex encoding.
+        static bool Load(const std::filesystem::path& sourcePath, VertexEncoding vertexEncoding, Geometry& geometry);
+
+        // `sourceStamp` must be taken before `sourceContent` is read. An edit made in between then leaves a stamp that
+        // doesn't match the file, so the next load checks the content hash rather than trusting a stale cache.
+        static bool Store(const std::filesystem::path& sourcePath, const SourceStamp& sourceStamp,
+                          std::string_view sourceContent, const Geometry& geometry);
+
+    private:
+    };
+}
+
+#endif // WR_GEOMETRYCACHE_HPP
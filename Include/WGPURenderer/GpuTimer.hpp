@@ -0,0 +1,108 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_GPUTIMER_HPP
+#define WR_GPUTIMER_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace WGPURenderer {
+    // Measures the GPU time of render passes with timestamp queries. Each timed frame resolves its queries into a
+    // readback buffer of a small ring, which is mapped asynchronously and read a few frames later, so that the CPU
+    // never waits for the GPU. Frames for which every buffer of the ring is still in flight aren't timed.
+    class GpuTimer {
+    public:
+        static constexpr uint32_t MaxPassCount = 4;
+        static constexpr uint32_t SlotCount = 4;
+
+        struct PassTiming {
+            std::string_view name;
+            double duration; // In milliseconds.
+        };
+
+        struct FrameTiming {
+            uint64_t frameIndex;
+            double duration; // Sum of the durations of the timed passes, in milliseconds.
+        };
+
+        GpuTimer() = default;
+        ~GpuTimer() = default;
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer(GpuTimer&&) = delete;
+
+        GpuTimer& operator=(const GpuTimer&) = delete;
+        GpuTimer& operator=(GpuTimer&&) = delete;
+
+        // The device must have been created with the TimestampQuery feature.
+        bool Initialize(wgpu::Device device);
+        void Terminate();
+
+        [[nodiscard]] bool IsEnabled() const;
+
+        // Timestamp writes for the next render pass of the frame being recorded, nullptr if it isn't timed. `name`
+        // must outlive the timer.
+        [[nodiscard]] const wgpu::RenderPassTimestampWrites* BeginPass(std::string_view name);
+
+        // Resolves the queries of the frame, before its encoder is finished.
+        void ResolveFrame(wgpu::CommandEncoder encoder);
+
+        // Starts reading the queries back, once the frame was submitted.
+        void EndFrame();
+
+        // Reads the frames whose queries are available, appending their timings to `completedFrames`.
+        void Update(std::pmr::vector<FrameTiming>& completedFrames);
+
+        // Index that the next frame passed to EndFrame() will have.
+        [[nodiscard]] uint64_t GetFrameIndex() const;
+
+        // Per-pass durations of the most recent frame that was read back.
+        [[nodiscard]] std::span<const PassTiming> GetLatestPassTimings() const;
+
+    private:
+        enum class SlotState : uint8_t {
+            Available,
+            Recording,
+            Mapping,
+            Mapped,
+            MapFailed,
+        };
+
+        struct Slot {
+            wgpu::Buffer readbackBuffer = nullptr;
+            SlotState state = SlotState::Available;
+            uint32_t passCount = 0;
+            uint64_t frameIndex = 0;
+            std::array<std::string_view, MaxPassCount> passNames{};
+        };
+
+        static void OnReadbackMapped(WGPUBufferMapAsyncStatus status, void* userdata);
+
+        static constexpr uint32_t QueriesPerSlot = 2 * MaxPassCount;
+        // Query resolution offsets must be aligned on 256 bytes.
+        static constexpr uint64_t ResolveSlotSize = 256;
+
+        wgpu::QuerySet m_QuerySet = nullptr;
+        wgpu::Buffer m_ResolveBuffer = nullptr;
+        std::array<Slot, SlotCount> m_Slots;
+        Slot* m_CurrentSlot = nullptr;
+        bool m_CurrentFrameSkipped = false;
+        uint64_t m_FrameIndex = 0;
+        wgpu::RenderPassTimestampWrites m_TimestampWrites{};
+        std::array<PassTiming, MaxPassCount> m_LatestPassTimings{};
+        uint32_t m_LatestPassCount = 0;
+        uint64_t m_LatestFrameIndex = 0;
+    };
+}
+
+#endif // WR_GPUTIMER_HPP
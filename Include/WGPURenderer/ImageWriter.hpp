@@ -0,0 +1,41 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_IMAGEWRITER_HPP
+#define WR_IMAGEWRITER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace WGPURenderer {
+    // Writes tightly packed 8-bit RGBA pixels, top row first.
+    class ImageWriter {
+    public:
+        ImageWriter() = delete;
+        ~ImageWriter() = delete;
+
+        ImageWriter(const ImageWriter&) = delete;
+        ImageWriter(ImageWriter&&) = delete;
+
+        ImageWriter& operator=(const ImageWriter&) = delete;
+        ImageWriter& operator=(ImageWriter&&) = delete;
+
+        // Picks the format from the extension of `path`.
+        static bool Write(const std::filesystem::path& path, uint32_t width, uint32_t height,
+                          std::span<const uint8_t> pixels);
+
+        // Binary PPM, the alpha channel is dropped.
+        static bool WritePPM(const std::filesystem::path& path, uint32_t width, uint32_t height,
+                             std::span<const uint8_t> pixels);
+
+        // Uncompressed PNG: the zlib stream only uses stored blocks, which keeps it dependency free.
+        static bool WritePNG(const std::filesystem::path& path, uint32_t width, uint32_t height,
+                             std::span<const uint8_t> pixels);
+    };
+}
+
+#endif // WR_IMAGEWRITER_HPP
@@ -0,0 +1,85 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_INDIRECTDRAW_HPP
+#define WR_INDIRECTDRAW_HPP
+
+#include <WGPURenderer/InstanceBuffer.hpp>
+#include <WGPURenderer/MeshPool.hpp>
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstdint>
+
+namespace WGPURenderer {
+    // Draws the instances with drawIndexedIndirect, whose arguments live in a GPU buffer. With GPU culling, a compute
+    // pass culls the instances against the view, compacts the visible ones and counts them in the arguments, so that
+    // the CPU never touches the objects nor reads anything back. Without it, the CPU writes arguments that draw
+    // every instance.
+    class IndirectDraw {
+    public:
+        static constexpr uint32_t WorkgroupSize = 64;
+
+        IndirectDraw() = default;
+        ~IndirectDraw() = default;
+
+        IndirectDraw(const IndirectDraw&) = delete;
+        IndirectDraw(IndirectDraw&&) = delete;
+
+        IndirectDraw& operator=(const IndirectDraw&) = delete;
+        IndirectDraw& operator=(IndirectDraw&&) = delete;
+
+        bool Initialize(wgpu::Device device, wgpu::Queue queue, bool gpuCulling);
+        void Terminate();
+
+        // Writes the draw arguments of the frame and records the culling pass, before the render pass. The instances
+        // must have been uploaded.
+        bool Prepare(wgpu::CommandEncoder encoder, const InstanceBuffer& instances, const MeshRange& mesh,
+                     float meshRadius, float aspectRatio);
+
+        // Binds the instances to draw to vertex buffer 1 and draws them. With GPU culling, nothing is drawn until the
+        // culling pass ran once.
+        void Draw(wgpu::RenderPassEncoder renderPass, const InstanceBuffer& instances);
+
+        [[nodiscard]] bool IsGpuCullingEnabled() const;
+
+    private:
+        // Matches CullParams in cull.wgsl.
+        struct CullParams {
+            uint32_t instanceCount;
+            float meshRadius;
+            float aspectRatio;
+            uint32_t padding;
+        };
+
+        // Matches the arguments of drawIndexedIndirect.
+        struct DrawArguments {
+            uint32_t indexCount;
+            uint32_t instanceCount;
+            uint32_t firstIndex;
+            int32_t baseVertex;
+            uint32_t firstInstance;
+        };
+
+        bool InitializeCulling();
+        // The bind group refers to the instance buffer, which is replaced when it grows.
+        bool UpdateCullingBindGroup(const InstanceBuffer& instances);
+
+        wgpu::Device m_Device = nullptr;
+        wgpu::Queue m_Queue = nullptr;
+        wgpu::Buffer m_ArgumentBuffer = nullptr;
+
+        bool m_GpuCulling = false;
+        wgpu::ComputePipeline m_CullPipeline = nullptr;
+        wgpu::Buffer m_CullParamsBuffer = nullptr;
+        wgpu::Buffer m_VisibleInstanceBuffer = nullptr;
+        wgpu::BindGroup m_CullBindGroup = nullptr;
+        // Instance buffer that m_CullBindGroup reads.
+        wgpu::Buffer m_BoundInstanceBuffer = nullptr;
+    };
+}
+
+#endif // WR_INDIRECTDRAW_HPP
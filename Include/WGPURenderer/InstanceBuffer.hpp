@@ -0,0 +1,77 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_INSTANCEBUFFER_HPP
+#define WR_INSTANCEBUFFER_HPP
+
+#include <WGPURenderer/StagingBelt.hpp>
+#include <WGPURenderer/VertexLayout.hpp>
+
+#include <webgpu/webgpu.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace WGPURenderer {
+    // Per-instance attributes, read by the vertex shader with an instance step mode.
+    struct InstanceData {
+        std::array<float, 2> offset{0.0f, 0.0f};
+        float scale = 1.0f;
+        float rotation = 0.0f;       // In radians.
+        uint32_t color = 0xFFFFFFFF; // RGBA8 with red in the lowest byte, multiplies the color of the mesh.
+    };
+
+    // Instances of a mesh, drawn with a single instanced draw call. Instances are edited on the CPU and only the
+    // range that changed since the last upload is written to the GPU.
+    class InstanceBuffer {
+    public:
+        // The instance attributes come after those of the mesh.
+        static constexpr uint32_t FirstShaderLocation = VertexLayout::MaxAttributeCount;
+        static constexpr size_t AttributeCount = 2;
+
+        InstanceBuffer() = default;
+        ~InstanceBuffer() = default;
+
+        InstanceBuffer(const InstanceBuffer&) = delete;
+        InstanceBuffer(InstanceBuffer&&) = delete;
+
+        InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+        InstanceBuffer& operator=(InstanceBuffer&&) = delete;
+
+        void Terminate();
+
+        // Returns the index of the instance.
+        uint32_t AddInstance(const InstanceData& instance);
+        void UpdateInstance(uint32_t index, const InstanceData& instance);
+        void Clear();
+
+        // Stages the instances that changed, growing the GPU buffer if needed. The instances past the belt's budget
+        // are left for the next uploads. Returns false if the buffer couldn't be created.
+        bool Upload(wgpu::Device device, StagingBelt& stagingBelt);
+
+        [[nodiscard]] uint32_t GetInstanceCount() const;
+        // Leading instances that the GPU buffer holds, the only ones that can be drawn. Fewer than the instances
+        // while a grown buffer is being filled over several frames.
+        [[nodiscard]] uint32_t GetUploadedCount() const;
+        [[nodiscard]] wgpu::Buffer GetBuffer() const;
+        // Size of the uploaded instances, to bind the buffer with.
+        [[nodiscard]] uint64_t GetSize() const;
+
+        static void BuildVertexAttributes(std::array<wgpu::VertexAttribute, AttributeCount>& attributes);
+
+    private:
+        std::vector<InstanceData> m_Instances;
+        wgpu::Buffer m_Buffer = nullptr;
+        uint64_t m_Capacity = 0; // In instances.
+        size_t m_UploadedCount = 0;
+        // Range of the instances to upload, empty when m_DirtyBegin >= m_DirtyEnd.
+        size_t m_DirtyBegin = 0;
+        size_t m_DirtyEnd = 0;
+    };
+}
+
+#endif // WR_INSTANCEBUFFER_HPP
@@ -0,0 +1,145 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_JOBSYSTEM_HPP
+#define WR_JOBSYSTEM_HPP
+
+#include <WGPURenderer/FrameArena.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace WGPURenderer {
+    class JobCounter;
+
+    // A range of work, `function` is called with `data`, `begin` and `end`.
+    struct Job {
+        void (*function)(void* data, uint32_t begin, uint32_t end) = nullptr;
+        void* data = nullptr;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        // Set by JobSystem::Run(), signaled once the job ran.
+        JobCounter* counter = nullptr;
+    };
+
+    // Counts the jobs of a batch that haven't completed yet.
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        // Schedules `continuation` once the batch run on this counter completed, the continuation then signals
+        // `continuationCounter`, which can be waited for right away. Such a counter is used for a single batch.
+        JobCounter(Job& continuation, JobCounter& continuationCounter);
+        ~JobCounter() = default;
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter(JobCounter&&) = delete;
+
+        JobCounter& operator=(const JobCounter&) = delete;
+        JobCounter& operator=(JobCounter&&) = delete;
+
+        [[nodiscard]] bool IsDone() const;
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> m_Count = 0;
+        Job* m_Continuation = nullptr;
+    };
+
+    // Runs jobs on a pool of worker threads. Each thread of the system pushes the jobs it creates to its own
+    // Chase-Lev deque and takes them back from the same end, while idle threads steal from the other end of the
+    // others' deques. Waiting for a counter runs jobs in the meantime, so jobs may wait for the jobs they create.
+    // Threads outside the system, such as the asset loader, hand their jobs over through a shared queue. The queues
+    // have a fixed capacity and the jobs are owned by their submitter, so that scheduling never allocates.
+    // Without Initialize(), or without workers, jobs run on the calling thread as soon as they are submitted.
+    class JobSystem {
+    public:
+        static constexpr uint32_t MaxWorkerCount = 63;
+        // Jobs queued on a thread, or in the shared queue, past this many run right away instead.
+        static constexpr uint32_t DequeCapacity = 1024;
+
+        JobSystem() = delete;
+        ~JobSystem() = delete;
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem(JobSystem&&) = delete;
+
+        JobSystem& operator=(const JobSystem&) = delete;
+        JobSystem& operator=(JobSystem&&) = delete;
+
+        // A worker count of 0 starts one worker per hardware thread besides the calling thread, which becomes the
+        // main thread of the system.
+        static void Initialize(uint32_t workerCount = 0);
+        // Every job submitted must have completed.
+        static void Terminate();
+
+        // The jobs must stay alive until the counter reaches zero.
+        static void Run(std::span<Job> jobs, JobCounter& counter);
+        // Runs queued jobs until the counter reaches zero.
+        static void Wait(const JobCounter& counter);
+
+        // Calls `func(begin, end)` over subranges of [0, count) of at least `grainSize` elements, in parallel, and
+        // returns once all of them completed.
+        template<typename Func>
+        static void ParallelFor(uint32_t count, uint32_t grainSize, Func&& func);
+
+        // Workers and main thread, 1 without workers.
+        [[nodiscard]] static uint32_t GetThreadCount();
+
+    private:
+        // Enough jobs per thread to balance uneven ranges, few enough to keep the scheduling cost low.
+        static constexpr uint32_t JobsPerThread = 4;
+
+        static void RunWorker(uint32_t threadIndex);
+
+        // Runs the job and signals its counter, scheduling the counter's continuation when it reaches zero.
+        static void Execute(Job& job);
+        // Queues the job without waking the workers up. Returns false if it ran right away instead.
+        static bool Enqueue(Job& job);
+        static void Schedule(Job& job);
+
+        template<typename Func>
+        static void InvokeRange(void* data, const uint32_t begin, const uint32_t end) {
+            (*static_cast<Func*>(data))(begin, end);
+        }
+    };
+
+    template<typename Func>
+    void JobSystem::ParallelFor(const uint32_t count, const uint32_t grainSize, Func&& func) {
+        const uint32_t rangeCount = (count + std::max(grainSize, 1u) - 1) / std::max(grainSize, 1u);
+        const uint32_t jobCount = std::min(rangeCount, GetThreadCount() * JobsPerThread);
+        if (jobCount <= 1) {
+            if (count != 0) {
+                func(0u, count);
+            }
+            return;
+        }
+
+        // The jobs only live until they are waited for, the thread's arena spares a heap allocation.
+        FrameArena& arena = FrameArena::GetThreadArena();
+        const FrameArena::Scope arenaScope(arena);
+
+        std::pmr::vector<Job> jobs(jobCount, &arena);
+        for (uint32_t i = 0; i < jobCount; ++i) {
+            jobs[i].function = &InvokeRange<std::remove_reference_t<Func>>;
+            jobs[i].data = const_cast<void*>(static_cast<const void*>(std::addressof(func)));
+            jobs[i].begin = static_cast<uint32_t>(uint64_t{count} * i / jobCount);
+            jobs[i].end = static_cast<uint32_t>(uint64_t{count} * (i + 1) / jobCount);
+        }
+
+        JobCounter counter;
+        Run(jobs, counter);
+        Wait(counter);
+    }
+}
+
+#endif // WR_JOBSYSTEM_HPP
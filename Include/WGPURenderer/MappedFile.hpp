@@ -0,0 +1,47 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_MAPPEDFILE_HPP
+#define WR_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace WGPURenderer {
+    // Read-only memory mapping of a whole file, unmapped on destruction. Empty files can't be mapped, they are open
+    // with an empty span.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool Open(const std::filesystem::path& path);
+
+        void Close();
+
+        [[nodiscard]] bool IsOpen() const;
+
+        [[nodiscard]] std::span<const std::byte> GetData() const;
+
+    private:
+        const std::byte* m_Data = nullptr;
+        size_t m_Size = 0;
+        bool m_IsOpen = false;
+#ifdef _WIN32
+        void* m_FileHandle = nullptr;
+        void* m_MappingHandle = nullptr;
+#endif
+    };
+}
+
+#endif // WR_MAPPEDFILE_HPP
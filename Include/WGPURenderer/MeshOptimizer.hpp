@@ -0,0 +1,56 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_MESHOPTIMIZER_HPP
+#define WR_MESHOPTIMIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace WGPURenderer {
+    struct VertexCacheStatistics {
+        float acmr = 0.0f; // Average cache miss ratio: transformed vertices per triangle, 0.5 at best.
+        float atvr = 0.0f; // Average transform to vertex ratio: transformed vertices per used vertex, 1.0 at best.
+    };
+
+    // Welds and reorders triangle lists for the post-transform vertex cache and the vertex fetch.
+    class MeshOptimizer {
+    public:
+        MeshOptimizer() = delete;
+        ~MeshOptimizer() = delete;
+
+        MeshOptimizer(const MeshOptimizer&) = delete;
+        MeshOptimizer(MeshOptimizer&&) = delete;
+
+        MeshOptimizer& operator=(const MeshOptimizer&) = delete;
+        MeshOptimizer& operator=(MeshOptimizer&&) = delete;
+
+        // Simulated FIFO cache size, conservative enough for most GPUs.
+        static constexpr size_t DefaultCacheSize = 16;
+
+        // Collapses bit-identical vertices into one and rewrites `indices` to match. Returns the new vertex count.
+        static size_t WeldVertices(std::span<uint32_t> indices, std::vector<float>& vertices, size_t componentCount);
+
+        static VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount,
+                                                        size_t cacheSize = DefaultCacheSize);
+
+        // Tipsify (Sander et al. 2007). Triangles keep their winding but not their order, which matters for
+        // overlapping triangles drawn without depth testing.
+        static void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount,
+                                        size_t cacheSize = DefaultCacheSize);
+
+        // Sorts the vertices by first use in `indices` and remaps the indices accordingly. Unreferenced vertices are
+        // dropped. Returns the new vertex count.
+        static size_t OptimizeVertexFetch(std::span<uint32_t> indices, std::vector<float>& vertices,
+                                          size_t componentCount);
+
+    private:
+    };
+}
+
+#endif // WR_MESHOPTIMIZER_HPP
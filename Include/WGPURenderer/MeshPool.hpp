@@ -0,0 +1,115 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_MESHPOOL_HPP
+#define WR_MESHPOOL_HPP
+
+#include <WGPURenderer/Geometry.hpp>
+#include <WGPURenderer/OffsetAllocator.hpp>
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace WGPURenderer {
+    using MeshHandle = uint32_t;
+    constexpr MeshHandle InvalidMesh = std::numeric_limits<MeshHandle>::max();
+
+    // Where a mesh lives in the pool's buffers, as drawIndexed's arguments.
+    struct MeshRange {
+        uint32_t indexCount = 0;
+        uint32_t firstIndex = 0;
+        int32_t baseVertex = 0;
+    };
+
+    struct MeshPoolStatistics {
+        uint32_t meshCount = 0;
+        OffsetAllocatorStatistics vertices; // In vertices.
+        OffsetAllocatorStatistics indices;  // In indices.
+    };
+
+    // Meshes sharing a vertex layout, sub-allocated from one vertex buffer and one index buffer. Every mesh is drawn
+    // from the same bindings with its own firstIndex and baseVertex, so drawing many meshes doesn't rebind anything.
+    // The buffers grow when they are full; growing and defragmenting copy the meshes to new buffers on the GPU,
+    // which replace the previous ones: the bindings must be set again afterward.
+    class MeshPool {
+    public:
+        MeshPool() = default;
+        ~MeshPool() = default;
+
+        MeshPool(const MeshPool&) = delete;
+        MeshPool(MeshPool&&) = delete;
+
+        MeshPool& operator=(const MeshPool&) = delete;
+        MeshPool& operator=(MeshPool&&) = delete;
+
+        // Capacities are in vertices and indices. The index format is the pool's for its whole lifetime: a 16-bit pool
+        // rejects meshes whose indices need 32 bits.
+        bool Initialize(wgpu::Device device, wgpu::Queue queue, uint32_t vertexStride, wgpu::IndexFormat indexFormat,
+                        uint32_t vertexCapacity, uint32_t indexCapacity);
+        void Terminate();
+
+        // Uploads the geometry, whose stride must match the pool's. 16-bit indices are widened in a 32-bit pool.
+        // When the free space is large enough but scattered, the pool is defragmented first, which changes the ranges
+        // of the other meshes. Returns InvalidMesh on failure.
+        MeshHandle AddMesh(const Geometry& geometry);
+        // The range can be reused right away: the uploads of later meshes are queue writes, which are ordered after
+        // the frames submitted before them. The frame being recorded must not have drawn the mesh though.
+        void RemoveMesh(MeshHandle mesh);
+
+        // Moves the meshes to the start of new buffers, so that the free space is a single region again. The ranges
+        // of the meshes change.
+        bool Defragment();
+
+        // Binds the vertex buffer to slot 0 and the index buffer.
+        void Bind(wgpu::RenderPassEncoder renderPass) const;
+
+        [[nodiscard]] MeshRange GetMeshRange(MeshHandle mesh) const;
+        [[nodiscard]] wgpu::IndexFormat GetIndexFormat() const;
+        [[nodiscard]] MeshPoolStatistics GetStatistics() const;
+
+    private:
+        // A GPU buffer carved into elements of the same size.
+        struct Pool {
+            wgpu::Buffer buffer = nullptr;
+            OffsetAllocator allocator;
+            wgpu::BufferUsageFlags usage = wgpu::BufferUsage::None;
+            uint32_t elementSize = 0;
+            // Allocations are multiples of this many elements, so that copies and writes stay 4 bytes aligned.
+            uint32_t granularity = 1;
+            const char* label = nullptr;
+        };
+
+        struct Mesh {
+            OffsetAllocator::Allocation vertices;
+            OffsetAllocator::Allocation indices;
+            uint32_t indexCount = 0;
+            bool used = false;
+        };
+
+        bool InitializePool(Pool& pool, uint32_t elementSize, uint32_t capacity);
+        static void TerminatePool(Pool& pool);
+        // Allocates `count` elements, growing the pool if needed.
+        bool AllocateElements(Pool& pool, uint32_t count, OffsetAllocator::Allocation& allocation);
+        // Replaces the pool's buffer with one of `capacity` elements. With `pack`, the live allocations are moved to
+        // the start of the new buffer, otherwise they keep their offsets.
+        bool Relocate(Pool& pool, uint32_t capacity, bool pack);
+
+        OffsetAllocator::Allocation& GetAllocation(Mesh& mesh, const Pool& pool);
+
+        wgpu::Device m_Device = nullptr;
+        wgpu::Queue m_Queue = nullptr;
+        wgpu::IndexFormat m_IndexFormat = wgpu::IndexFormat::Undefined;
+        Pool m_VertexPool;
+        Pool m_IndexPool;
+        std::vector<Mesh> m_Meshes;
+        std::vector<MeshHandle> m_FreeHandles;
+    };
+}
+
+#endif // WR_MESHPOOL_HPP
@@ -0,0 +1,106 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_OFFSETALLOCATOR_HPP
+#define WR_OFFSETALLOCATOR_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace WGPURenderer {
+    struct OffsetAllocatorStatistics {
+        uint32_t capacity = 0;
+        uint32_t usedSize = 0;
+        uint32_t freeSize = 0;
+        uint32_t largestFreeRegion = 0;
+        uint32_t allocationCount = 0;
+        uint32_t freeRegionCount = 0;
+
+        // 0 when the free space is a single region, close to 1 when it's scattered in small regions.
+        [[nodiscard]] float GetFragmentation() const;
+        [[nodiscard]] float GetOccupancy() const;
+    };
+
+    // Two-level segregated fit allocator of ranges in [0, capacity), in abstract units: it never touches the memory
+    // it hands out, so it can carve up GPU buffers. Allocating and freeing are O(1): free regions are binned by size
+    // on a logarithmic scale split in 8 linear steps, and neighbours are merged back as soon as they are freed. Only
+    // an allocation that no larger bin can hold searches the regions of its own bin.
+    class OffsetAllocator {
+    public:
+        static constexpr uint32_t InvalidNode = std::numeric_limits<uint32_t>::max();
+
+        struct Allocation {
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            uint32_t node = InvalidNode; // Identifies the allocation when freeing it.
+        };
+
+        OffsetAllocator() = default;
+        ~OffsetAllocator() = default;
+
+        OffsetAllocator(const OffsetAllocator&) = delete;
+        OffsetAllocator(OffsetAllocator&&) = delete;
+
+        OffsetAllocator& operator=(const OffsetAllocator&) = delete;
+        OffsetAllocator& operator=(OffsetAllocator&&) = delete;
+
+        // Frees everything, the whole capacity becomes a single free region.
+        void Reset(uint32_t capacity);
+        // Adds free space at the end, `capacity` can't be lower than the current one.
+        void Grow(uint32_t capacity);
+
+        // Returns false if no free region is large enough.
+        bool Allocate(uint32_t size, Allocation& allocation);
+        void Free(const Allocation& allocation);
+
+        [[nodiscard]] uint32_t GetCapacity() const;
+        [[nodiscard]] OffsetAllocatorStatistics GetStatistics() const;
+
+    private:
+        static constexpr uint32_t SecondLevelBits = 3;
+        static constexpr uint32_t SecondLevelCount = 1 << SecondLevelBits;
+        // Sizes below SecondLevelCount get a bin each, then each power of two is split in SecondLevelCount bins.
+        static constexpr uint32_t FirstLevelCount = 32 - SecondLevelBits + 1;
+
+        struct Node {
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            // Neighbours in memory.
+            uint32_t previous = InvalidNode;
+            uint32_t next = InvalidNode;
+            // Neighbours in the bin, for free nodes.
+            uint32_t previousFree = InvalidNode;
+            uint32_t nextFree = InvalidNode;
+            bool free = false;
+        };
+
+        static uint32_t GetBinIndex(uint32_t size);
+        // Smallest bin whose regions all fit `size`, may be past the last bin.
+        static uint32_t GetFittingBinIndex(uint32_t size);
+
+        uint32_t CreateNode(uint32_t offset, uint32_t size);
+        void DestroyNode(uint32_t node);
+        void InsertFreeNode(uint32_t node);
+        void RemoveFreeNode(uint32_t node);
+        // First non-empty bin at or after `binIndex`, InvalidNode if there's none.
+        uint32_t FindFreeBin(uint32_t binIndex) const;
+
+        std::vector<Node> m_Nodes;
+        std::vector<uint32_t> m_UnusedNodes;
+        std::array<uint32_t, FirstLevelCount * SecondLevelCount> m_BinHeads{};
+        std::array<uint8_t, FirstLevelCount> m_SecondLevelBitmaps{};
+        uint32_t m_FirstLevelBitmap = 0;
+        uint32_t m_LastNode = InvalidNode;
+        uint32_t m_Capacity = 0;
+        uint32_t m_UsedSize = 0;
+        uint32_t m_AllocationCount = 0;
+        uint32_t m_FreeRegionCount = 0;
+    };
+}
+
+#endif // WR_OFFSETALLOCATOR_HPP
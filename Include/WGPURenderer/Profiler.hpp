@@ -0,0 +1,86 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_PROFILER_HPP
+#define WR_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace WGPURenderer {
+    // Records named CPU scopes in per-thread buffers and writes them as a Chrome trace, which chrome://tracing and
+    // Perfetto can open. Recording only touches the buffer of the calling thread, without any lock.
+    class Profiler {
+    public:
+        Profiler() = delete;
+        ~Profiler() = delete;
+
+        Profiler(const Profiler&) = delete;
+        Profiler(Profiler&&) = delete;
+
+        Profiler& operator=(const Profiler&) = delete;
+        Profiler& operator=(Profiler&&) = delete;
+
+        // `name` must be a string literal, or at least outlive the profiler.
+        static void RecordScope(const char* name, uint64_t start, uint64_t end);
+
+        // Names the calling thread in the trace.
+        static void SetThreadName(const char* name);
+
+        // Nanoseconds since the start of the process.
+        static uint64_t GetTimestamp() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - s_Epoch).count());
+        }
+
+        // The other threads must have stopped recording.
+        static bool WriteChromeTrace(const std::filesystem::path& path);
+
+        // Average cost of a profiled scope in nanoseconds, measured on the calling thread. The scopes recorded for
+        // the measurement are discarded.
+        static double MeasureScopeOverhead(size_t scopeCount);
+
+    private:
+        static const std::chrono::steady_clock::time_point s_Epoch;
+    };
+
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name)
+            : m_Name(name), m_Start(Profiler::GetTimestamp()) {
+        }
+
+        ~ProfileScope() {
+            Profiler::RecordScope(m_Name, m_Start, Profiler::GetTimestamp());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope(ProfileScope&&) = delete;
+
+        ProfileScope& operator=(const ProfileScope&) = delete;
+        ProfileScope& operator=(ProfileScope&&) = delete;
+
+    private:
+        const char* m_Name;
+        uint64_t m_Start;
+    };
+}
+
+#define WR_PROFILE_CONCAT_IMPL(a, b) a##b
+#define WR_PROFILE_CONCAT(a, b) WR_PROFILE_CONCAT_IMPL(a, b)
+
+// Profiles the rest of the enclosing scope. Compiled out unless the `profiling` option is enabled.
+#ifdef WR_PROFILING
+#define WR_PROFILE_SCOPE(name) const ::WGPURenderer::ProfileScope WR_PROFILE_CONCAT(wrProfileScope, __LINE__)(name)
+#define WR_PROFILE_THREAD(name) ::WGPURenderer::Profiler::SetThreadName(name)
+#else
+#define WR_PROFILE_SCOPE(name) static_cast<void>(0)
+#define WR_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+#endif // WR_PROFILER_HPP
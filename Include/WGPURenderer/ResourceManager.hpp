@@ -7,6 +7,8 @@
 #ifndef WR_RESOURCEMANAGER_HPP
 #define WR_RESOURCEMANAGER_HPP
 
+#include <WGPURenderer/Geometry.hpp>
+
 #include <webgpu/webgpu.hpp>
 
 #include <filesystem>
@@ -24,9 +26,21 @@ namespace WGPURenderer {
         ResourceManager& operator=(const ResourceManager&) = delete;
         ResourceManager& operator=(ResourceManager&&) = delete;
 
+        // `pointData` holds `layout.GetComponentCount()` floats per vertex, in the order of the layout's attributes.
+        // Large files are split at line boundaries into `threadCount` chunks (0 for one per thread of the job
+        // system, 1 to stay on the calling thread), parsed in parallel by the job system. The output doesn't depend
+        // on the thread count.
         static bool LoadGeometry(const std::filesystem::path& path,
+                                 VertexLayout& layout,
                                  std::vector<float>& pointData,
-                                 std::vector<uint16_t>& indexData);
+                                 std::vector<uint32_t>& indexData,
+                                 unsigned int threadCount = 0);
+
+        // Goes through the binary geometry cache, which is (re)built from the text file when missing or stale.
+        // Whether the quantized encoding is precise enough is a per-asset decision, its errors are reported when
+        // the cache is built.
+        static bool LoadGeometry(const std::filesystem::path& path, Geometry& geometry,
+                                 VertexEncoding vertexEncoding = VertexEncoding::Float);
 
         static wgpu::ShaderModule LoadShaderModule(const std::filesystem::path& path,
                                                    wgpu::Device device);
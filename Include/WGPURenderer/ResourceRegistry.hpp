@@ -0,0 +1,139 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_RESOURCEREGISTRY_HPP
+#define WR_RESOURCEREGISTRY_HPP
+
+#include <WGPURenderer/FrameRing.hpp>
+
+#include <webgpu/webgpu.hpp>
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+namespace WGPURenderer {
+    // Refers to a resource of the registry. The low bits index its slot, the high bits hold the generation of the
+    // slot, which changes when the resource is destroyed so that the handles still pointing to it stop resolving.
+    // A default constructed handle is null, no resource ever has it.
+    template<typename T>
+    class ResourceHandle {
+    public:
+        constexpr ResourceHandle() = default;
+
+        explicit constexpr operator bool() const {
+            return m_Value != 0;
+        }
+
+        constexpr bool operator==(const ResourceHandle&) const = default;
+
+    private:
+        template<typename... Ts>
+        friend class BasicResourceRegistry;
+
+        explicit constexpr ResourceHandle(const uint32_t value)
+            : m_Value(value) {
+        }
+
+        uint32_t m_Value = 0;
+    };
+
+    using BufferHandle = ResourceHandle<wgpu::Buffer>;
+    using TextureHandle = ResourceHandle<wgpu::Texture>;
+    using ShaderModuleHandle = ResourceHandle<wgpu::ShaderModule>;
+    using RenderPipelineHandle = ResourceHandle<wgpu::RenderPipeline>;
+    using BindGroupHandle = ResourceHandle<wgpu::BindGroup>;
+
+    // Owns GPU objects behind generational handles. Each kind of object has its own pool, whose objects and slot
+    // generations are stored in separate arrays indexed by the handle, so that resolving a handle is a bounds check,
+    // a generation check and a load. Destroying a resource invalidates its handles right away, but the object is
+    // only released once the frames in flight that may use it completed, as told by BeginFrame().
+    // `Resources` are the kinds of objects, handle types which are null when constructed from nullptr and which
+    // are released with release(), and destroyed beforehand with destroy() when they have one.
+    template<typename... Resources>
+    class BasicResourceRegistry {
+    public:
+        static constexpr uint32_t IndexBits = 20;
+        // Per kind of resource.
+        static constexpr uint32_t MaxResourceCount = 1 << IndexBits;
+
+        BasicResourceRegistry() = default;
+        ~BasicResourceRegistry() = default;
+
+        BasicResourceRegistry(const BasicResourceRegistry&) = delete;
+        BasicResourceRegistry(BasicResourceRegistry&&) = delete;
+
+        BasicResourceRegistry& operator=(const BasicResourceRegistry&) = delete;
+        BasicResourceRegistry& operator=(BasicResourceRegistry&&) = delete;
+
+        // Releases every resource, destroyed or not. The GPU must be done with them, see FrameRing::Terminate().
+        void Terminate();
+
+        // Takes the ownership of the object. Returns a null handle if the object is null or the pool is full.
+        template<typename T>
+        ResourceHandle<T> Add(T object);
+
+        // Returns nullptr for null and stale handles. Debug builds report the stale ones.
+        template<typename T>
+        [[nodiscard]] T Get(ResourceHandle<T> handle) const;
+
+        // The object is released by the BeginFrame() that reuses the current frame slot.
+        template<typename T>
+        void Destroy(ResourceHandle<T> handle);
+
+        // Called once FrameRing::BeginFrame() returned the slot: the frame that last used it is complete, so are the
+        // resources destroyed during that frame.
+        void BeginFrame(uint32_t frameSlot);
+
+        // Resources destroyed whose object isn't released yet.
+        [[nodiscard]] uint32_t GetPendingDestructionCount() const;
+
+    private:
+        static constexpr uint32_t IndexMask = MaxResourceCount - 1;
+        // Generation 0 is skipped, so that no handle is null.
+        static constexpr uint32_t MaxGeneration = (1u << (32 - IndexBits)) - 1;
+
+        template<typename T>
+        struct Pool {
+            std::vector<T> objects;
+            std::vector<uint16_t> generations;
+            std::vector<uint32_t> freeIndices;
+            // Destroyed during the last frame of each slot.
+            std::array<std::vector<uint32_t>, FrameRing::MaxFramesInFlight> retiredIndices;
+        };
+
+        template<typename T>
+        Pool<T>& GetPool();
+
+        template<typename T>
+        const Pool<T>& GetPool() const;
+
+        // The index of the handle's slot, if its generation is current.
+        template<typename T>
+        [[nodiscard]] bool Resolve(ResourceHandle<T> handle, uint32_t& index) const;
+
+        template<typename T>
+        static void ReleaseRetired(Pool<T>& pool, uint32_t frameSlot);
+
+        template<typename T>
+        static void ReleaseAll(Pool<T>& pool);
+
+        template<typename T>
+        static void ReleaseObject(T& object);
+
+        std::tuple<Pool<Resources>...> m_Pools;
+        uint32_t m_CurrentSlot = 0;
+    };
+
+    using ResourceRegistry = BasicResourceRegistry<wgpu::Buffer, wgpu::Texture, wgpu::ShaderModule,
+                                                   wgpu::RenderPipeline, wgpu::BindGroup>;
+}
+
+#include <WGPURenderer/ResourceRegistry.inl>
+
+#endif // WR_RESOURCEREGISTRY_HPP
@@ -0,0 +1,163 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+namespace WGPURenderer {
+    template<typename... Resources>
+    void BasicResourceRegistry<Resources...>::Terminate() {
+        std::apply([](auto&... pools) {
+            (ReleaseAll(pools), ...);
+        }, m_Pools);
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    ResourceHandle<T> BasicResourceRegistry<Resources...>::Add(T object) {
+        if (!object) {
+            return {};
+        }
+
+        Pool<T>& pool = GetPool<T>();
+
+        uint32_t index;
+        if (!pool.freeIndices.empty()) {
+            index = pool.freeIndices.back();
+            pool.freeIndices.pop_back();
+        } else if (pool.objects.size() < MaxResourceCount) {
+            index = static_cast<uint32_t>(pool.objects.size());
+            pool.objects.emplace_back(nullptr);
+            pool.generations.push_back(1);
+        } else {
+            std::cerr << "The resource registry is full!\n";
+            ReleaseObject(object);
+            return {};
+        }
+
+        pool.objects[index] = object;
+        return ResourceHandle<T>((uint32_t{pool.generations[index]} << IndexBits) | index);
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    T BasicResourceRegistry<Resources...>::Get(const ResourceHandle<T> handle) const {
+        uint32_t index;
+        if (!Resolve(handle, index)) {
+            return nullptr;
+        }
+
+        return GetPool<T>().objects[index];
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    void BasicResourceRegistry<Resources...>::Destroy(const ResourceHandle<T> handle) {
+        uint32_t index;
+        if (!Resolve(handle, index)) {
+            return;
+        }
+
+        Pool<T>& pool = GetPool<T>();
+        uint16_t& generation = pool.generations[index];
+        generation = generation == MaxGeneration ? 1 : generation + 1;
+
+        pool.retiredIndices[m_CurrentSlot].push_back(index);
+    }
+
+    template<typename... Resources>
+    void BasicResourceRegistry<Resources...>::BeginFrame(const uint32_t frameSlot) {
+        m_CurrentSlot = frameSlot;
+
+        std::apply([frameSlot](auto&... pools) {
+            (ReleaseRetired(pools, frameSlot), ...);
+        }, m_Pools);
+    }
+
+    template<typename... Resources>
+    uint32_t BasicResourceRegistry<Resources...>::GetPendingDestructionCount() const {
+        size_t count = 0;
+        const auto countRetired = [&count](const auto& pool) {
+            for (const std::vector<uint32_t>& indices : pool.retiredIndices) {
+                count += indices.size();
+            }
+        };
+
+        std::apply([&countRetired](const auto&... pools) {
+            (countRetired(pools), ...);
+        }, m_Pools);
+
+        return static_cast<uint32_t>(count);
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    auto BasicResourceRegistry<Resources...>::GetPool() -> Pool<T>& {
+        return std::get<Pool<T>>(m_Pools);
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    auto BasicResourceRegistry<Resources...>::GetPool() const -> const Pool<T>& {
+        return std::get<Pool<T>>(m_Pools);
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    bool BasicResourceRegistry<Resources...>::Resolve(const ResourceHandle<T> handle, uint32_t& index) const {
+        if (!handle) {
+            return false;
+        }
+
+        const Pool<T>& pool = GetPool<T>();
+        index = handle.m_Value & IndexMask;
+        if (index >= pool.generations.size() || pool.generations[index] != handle.m_Value >> IndexBits) {
+#ifdef WR_DEBUG
+            std::cerr << "Use of a stale resource handle, its resource was destroyed!\n";
+#endif
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    void BasicResourceRegistry<Resources...>::ReleaseRetired(Pool<T>& pool, const uint32_t frameSlot) {
+        for (const uint32_t index : pool.retiredIndices[frameSlot]) {
+            ReleaseObject(pool.objects[index]);
+            pool.freeIndices.push_back(index);
+        }
+
+        pool.retiredIndices[frameSlot].clear();
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    void BasicResourceRegistry<Resources...>::ReleaseAll(Pool<T>& pool) {
+        for (T& object : pool.objects) {
+            if (object) {
+                ReleaseObject(object);
+            }
+        }
+
+        pool.objects.clear();
+        pool.generations.clear();
+        pool.freeIndices.clear();
+        for (std::vector<uint32_t>& indices : pool.retiredIndices) {
+            indices.clear();
+        }
+    }
+
+    template<typename... Resources>
+    template<typename T>
+    void BasicResourceRegistry<Resources...>::ReleaseObject(T& object) {
+        // Buffers and textures hold memory until they are destroyed, even if the API keeps references to them.
+        if constexpr (requires { object.destroy(); }) {
+            object.destroy();
+        }
+
+        object.release();
+        object = nullptr;
+    }
+}
@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_STAGINGBELT_HPP
+#define WR_STAGINGBELT_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace WGPURenderer {
+    // Uploads through mapped staging buffers: callers write straight into mapped memory, and the copies to the
+    // destination buffers are recorded together in the frame's encoder. Chunks are mapped again once the GPU is done
+    // copying from them, then reused. An optional budget bounds the bytes uploaded per frame, the uploads past it
+    // are refused and must be retried on a later frame.
+    class StagingBelt {
+    public:
+        static constexpr uint64_t DefaultChunkSize = 1 << 20;
+
+        StagingBelt() = default;
+        ~StagingBelt() = default;
+
+        StagingBelt(const StagingBelt&) = delete;
+        StagingBelt(StagingBelt&&) = delete;
+
+        StagingBelt& operator=(const StagingBelt&) = delete;
+        StagingBelt& operator=(StagingBelt&&) = delete;
+
+        // A frame budget of 0 doesn't limit the uploads.
+        void Initialize(wgpu::Device device, uint64_t chunkSize, uint64_t frameBudget);
+        void Terminate();
+
+        // Returns the mapped memory to write `size` bytes to, which are copied to `destination` when the frame's
+        // uploads are recorded. `destinationOffset` and `size` must be multiples of 4. Returns nullptr if the
+        // frame's budget is spent or if no staging buffer could be created. The destination is kept alive until
+        // Finish().
+        void* Upload(wgpu::Buffer destination, uint64_t destinationOffset, uint64_t size);
+
+        // Records the copies of the frame's uploads, before any command that reads their destinations. The encoder
+        // must be submitted before Recall().
+        void Finish(wgpu::CommandEncoder encoder);
+        // Maps the chunks of the submitted uploads again, they are reused once the mapping completes.
+        void Recall();
+
+        [[nodiscard]] uint64_t GetFrameUploadSize() const;
+        // Bytes that the frame can still upload.
+        [[nodiscard]] uint64_t GetRemainingBudget() const;
+        [[nodiscard]] size_t GetChunkCount() const;
+
+    private:
+        enum class ChunkState : uint8_t {
+            Mapped,    // Available for the uploads.
+            Recording, // Holds uploads of the current frame.
+            Submitted, // Unmapped, its copies were recorded.
+            Mapping,
+            MapFailed,
+        };
+
+        struct Chunk {
+            wgpu::Buffer buffer = nullptr;
+            std::byte* mappedData = nullptr;
+            uint64_t size = 0;
+            uint64_t usedSize = 0;
+            ChunkState state = ChunkState::Mapped;
+        };
+
+        struct Copy {
+            wgpu::Buffer source = nullptr;
+            uint64_t sourceOffset = 0;
+            wgpu::Buffer destination = nullptr;
+            uint64_t destinationOffset = 0;
+            uint64_t size = 0;
+        };
+
+        static void OnChunkMapped(WGPUBufferMapAsyncStatus status, void* userdata);
+
+        // A chunk with `size` free bytes, prepared for the current frame.
+        Chunk* AcquireChunk(uint64_t size);
+        Chunk* CreateChunk(uint64_t size);
+
+        wgpu::Device m_Device = nullptr;
+        uint64_t m_ChunkSize = DefaultChunkSize;
+        uint64_t m_FrameBudget = 0;
+        uint64_t m_FrameUploadSize = 0;
+        // Chunks are referenced by their map callbacks, so they don't move.
+        std::vector<std::unique_ptr<Chunk>> m_Chunks;
+        std::vector<Copy> m_Copies;
+    };
+}
+
+#endif // WR_STAGINGBELT_HPP
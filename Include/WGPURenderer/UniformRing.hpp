@@ -0,0 +1,66 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_UNIFORMRING_HPP
+#define WR_UNIFORMRING_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace WGPURenderer {
+    // Hands out the per-object uniforms of a frame as aligned slices of one large uniform buffer, bound once with a
+    // dynamic offset. The buffer is split in a region per frame in flight, so that a frame never overwrites the
+    // uniforms the GPU may still be reading. Allocations are staged on the CPU and the whole frame is uploaded with a
+    // single writeBuffer, however many objects it draws.
+    class UniformRing {
+    public:
+        UniformRing() = default;
+        ~UniformRing() = default;
+
+        UniformRing(const UniformRing&) = delete;
+        UniformRing(UniformRing&&) = delete;
+
+        UniformRing& operator=(const UniformRing&) = delete;
+        UniformRing& operator=(UniformRing&&) = delete;
+
+        // `frameSize` is the size of the region of each frame, rounded up to the device's uniform offset alignment.
+        bool Initialize(wgpu::Device device, uint32_t frameCount, uint64_t frameSize);
+        void Terminate();
+
+        // Starts filling the region of a frame slot, whose previous frame the GPU must have finished.
+        void BeginFrame(uint32_t frameSlot);
+
+        // Copies `size` bytes into the frame's region and returns the dynamic offset to bind them with. Returns
+        // false once the region is full.
+        bool Allocate(const void* data, uint32_t size, uint32_t& dynamicOffset);
+
+        template<typename T>
+        bool Allocate(const T& data, uint32_t& dynamicOffset) {
+            return Allocate(&data, sizeof(T), dynamicOffset);
+        }
+
+        // Uploads everything allocated since BeginFrame(), before the frame is submitted.
+        void EndFrame(wgpu::Queue queue);
+
+        [[nodiscard]] wgpu::Buffer GetBuffer() const;
+        [[nodiscard]] uint32_t GetAlignment() const;
+        // Bytes allocated in the current frame, padding included.
+        [[nodiscard]] uint64_t GetUsedSize() const;
+
+    private:
+        wgpu::Buffer m_Buffer = nullptr;
+        std::vector<std::byte> m_Staging;
+        uint32_t m_Alignment = 256;
+        uint64_t m_FrameSize = 0;
+        uint64_t m_FrameOffset = 0;
+        uint64_t m_UsedSize = 0;
+    };
+}
+
+#endif // WR_UNIFORMRING_HPP
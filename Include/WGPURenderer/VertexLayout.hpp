@@ -0,0 +1,74 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_VERTEXLAYOUT_HPP
+#define WR_VERTEXLAYOUT_HPP
+
+#include <webgpu/webgpu.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace WGPURenderer {
+    enum class VertexEncoding : uint32_t {
+        Float,     // Every component as a 32-bit float.
+        Quantized, // Snorm16 positions relative to the mesh bounds, Unorm8 colors, Snorm8 normals, Float16 UVs.
+    };
+
+    // The semantic also gives the shader location of the attribute.
+    enum class VertexSemantic : uint32_t {
+        Position,
+        Color,
+        Normal,
+        TexCoord,
+    };
+
+    struct VertexLayoutAttribute {
+        VertexSemantic semantic;
+        uint32_t componentCount;
+
+        bool operator==(const VertexLayoutAttribute&) const = default;
+    };
+
+    // Attributes of the vertices of a model, in the order in which their components appear in the file. Trivially
+    // copyable so that it can be stored as is in the geometry cache.
+    class VertexLayout {
+    public:
+        static constexpr size_t MaxAttributeCount = 4;
+
+        // Fails if the semantic is already used, if the component count doesn't suit it or if the layout is full.
+        bool AddAttribute(VertexSemantic semantic, uint32_t componentCount);
+
+        [[nodiscard]] std::span<const VertexLayoutAttribute> GetAttributes() const;
+        [[nodiscard]] bool HasAttribute(VertexSemantic semantic) const;
+
+        // Number of floats per vertex in the model file.
+        [[nodiscard]] uint32_t GetComponentCount() const;
+        [[nodiscard]] uint32_t GetStride(VertexEncoding encoding) const;
+
+        // Returns the number of attributes written in `attributes`.
+        size_t BuildVertexAttributes(VertexEncoding encoding,
+                                     std::array<wgpu::VertexAttribute, MaxAttributeCount>& attributes) const;
+
+        bool operator==(const VertexLayout&) const = default;
+
+        // x, y, r, g, b: the layout of models that don't declare one.
+        static VertexLayout GetDefault();
+
+        static bool ParseSemantic(std::string_view name, VertexSemantic& semantic);
+        static wgpu::VertexFormat GetVertexFormat(const VertexLayoutAttribute& attribute, VertexEncoding encoding);
+        static uint32_t GetEncodedSize(const VertexLayoutAttribute& attribute, VertexEncoding encoding);
+
+    private:
+        std::array<VertexLayoutAttribute, MaxAttributeCount> m_Attributes{};
+        uint32_t m_AttributeCount = 0;
+    };
+}
+
+#endif // WR_VERTEXLAYOUT_HPP
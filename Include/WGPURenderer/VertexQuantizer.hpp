@@ -0,0 +1,44 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_VERTEXQUANTIZER_HPP
+#define WR_VERTEXQUANTIZER_HPP
+
+#include <WGPURenderer/Geometry.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace WGPURenderer {
+    struct QuantizationReport {
+        float maxPositionError = 0.0f; // In model units.
+        float maxColorError = 0.0f;
+        float maxNormalError = 0.0f;
+        float maxTexCoordError = 0.0f;
+    };
+
+    // Produces the VertexEncoding::Quantized vertices out of float vertices.
+    class VertexQuantizer {
+    public:
+        VertexQuantizer() = delete;
+        ~VertexQuantizer() = delete;
+
+        VertexQuantizer(const VertexQuantizer&) = delete;
+        VertexQuantizer(VertexQuantizer&&) = delete;
+
+        VertexQuantizer& operator=(const VertexQuantizer&) = delete;
+        VertexQuantizer& operator=(VertexQuantizer&&) = delete;
+
+        // Positions are normalized to the bounds of the mesh, `transform` receives the mapping back to model units.
+        static std::vector<std::byte> Quantize(std::span<const float> points, const VertexLayout& layout,
+                                               PositionTransform& transform, QuantizationReport& report);
+
+    private:
+    };
+}
+
+#endif // WR_VERTEXQUANTIZER_HPP
@@ -0,0 +1,50 @@
+// Frustum culls the instances and writes the visible ones, compacted, along with the arguments of the indirect
+// draw that renders them.
+
+struct CullParams {
+    instanceCount: u32,
+    meshRadius: f32, // Bounding radius of the mesh around its origin, before the instance's scale.
+    aspectRatio: f32
+};
+
+// Matches drawIndexedIndirect's arguments. The instance count is reset to 0 before each dispatch.
+struct DrawArguments {
+    indexCount: u32,
+    instanceCount: atomic<u32>,
+    firstIndex: u32,
+    baseVertex: i32,
+    firstInstance: u32
+};
+
+// Instances are read as words since InstanceData is packed: offset.xy, scale, rotation, color.
+const InstanceWordCount = 5u;
+
+@group(0) @binding(0) var<uniform> uParams: CullParams;
+@group(0) @binding(1) var<storage, read> instances: array<u32>;
+@group(0) @binding(2) var<storage, read_write> visibleInstances: array<u32>;
+@group(0) @binding(3) var<storage, read_write> drawArguments: DrawArguments;
+
+@compute @workgroup_size(64)
+fn cs_main(@builtin(global_invocation_id) id: vec3u, @builtin(num_workgroups) workgroupCount: vec3u) {
+    // Large instance counts are dispatched on two dimensions.
+    let index = id.x + id.y * workgroupCount.x * 64u;
+    if (index >= uParams.instanceCount) {
+        return;
+    }
+
+    let base = index * InstanceWordCount;
+    let offset = vec2f(bitcast<f32>(instances[base]), bitcast<f32>(instances[base + 1u]));
+    let radius = uParams.meshRadius * bitcast<f32>(instances[base + 2u]);
+
+    // The bounding circle against the clip space bounds, the rotation doesn't change it.
+    let visible = offset.x + radius >= -1.0 && offset.x - radius <= 1.0 &&
+                  (offset.y + radius) * uParams.aspectRatio >= -1.0 && (offset.y - radius) * uParams.aspectRatio <= 1.0;
+    if (!visible) {
+        return;
+    }
+
+    let destination = atomicAdd(&drawArguments.instanceCount, 1u) * InstanceWordCount;
+    for (var word = 0u; word < InstanceWordCount; word++) {
+        visibleInstances[destination + word] = instances[base + word];
+    }
+}
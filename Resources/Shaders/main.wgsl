@@ -3,18 +3,49 @@ struct VertexInput {
     @location(1) color: vec3f
 };
 
+// Locations follow those of the mesh attributes.
+struct InstanceInput {
+    @location(4) transform: vec4f, // Offset in xy, scale in z, rotation in w.
+    @location(5) color: vec4f
+};
+
+struct MeshUniforms {
+    positionScale: vec3f,
+    positionOffset: vec3f
+};
+
+struct ViewUniforms {
+    aspectRatio: f32
+};
+
+// Bound with a dynamic offset into the uniform ring, one slice per object.
+struct ObjectUniforms {
+    offset: vec2f
+};
+
+@group(0) @binding(0) var<uniform> uMesh: MeshUniforms;
+@group(0) @binding(1) var<uniform> uView: ViewUniforms;
+@group(1) @binding(0) var<uniform> uObject: ObjectUniforms;
+
 struct VertexOutput {
     @builtin(position) position: vec4f,
     @location(0) color: vec3f
 };
 
 @vertex
-fn vs_main(in: VertexInput) -> VertexOutput {
+fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
     var out: VertexOutput;
-    let ratio = 640.0 / 480.0;
-    let offset = vec2f(-0.6875, -0.463); // The offset that we want to apply to the position
-    out.position = vec4f(in.position.x + offset.x, (in.position.y + offset.y) * ratio, 0.0, 1.0);
-    out.color = in.color; // Forward the color attribute to the fragment shader.
+    let ratio = uView.aspectRatio;
+    let offset = uObject.offset; // The offset that we want to apply to the position
+    // Quantized meshes store their positions normalized to their bounds.
+    let position = in.position * uMesh.positionScale.xy + uMesh.positionOffset.xy + offset;
+    // Rotate and scale the copy around the origin, then move it to its place.
+    let c = cos(instance.transform.w);
+    let s = sin(instance.transform.w);
+    let rotated = vec2f(c * position.x - s * position.y, s * position.x + c * position.y);
+    let placed = rotated * instance.transform.z + instance.transform.xy;
+    out.position = vec4f(placed.x, placed.y * ratio, 0.0, 1.0);
+    out.color = in.color * instance.color.rgb; // Forward the tinted color attribute to the fragment shader.
     return out;
 }
 
@@ -0,0 +1,77 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/AllocationCounter.hpp>
+
+#include <cstdlib>
+#include <new>
+
+namespace WGPURenderer {
+    namespace {
+        // Per thread, so that counting costs no synchronization and the loader threads don't skew the frame loop.
+        thread_local uint64_t t_AllocationCount = 0;
+
+        void* Allocate(size_t size) {
+            ++t_AllocationCount;
+            return std::malloc(size != 0 ? size : 1);
+        }
+
+        void* AllocateAligned(size_t size, const std::align_val_t alignment) {
+            ++t_AllocationCount;
+            const auto alignmentValue = static_cast<size_t>(alignment);
+            size = size != 0 ? size : 1;
+#ifdef _WIN32
+            return _aligned_malloc(size, alignmentValue);
+#else
+            // aligned_alloc requires a size that is a multiple of the alignment.
+            return std::aligned_alloc(alignmentValue, (size + alignmentValue - 1) / alignmentValue * alignmentValue);
+#endif
+        }
+
+        void FreeAligned(void* pointer) {
+#ifdef _WIN32
+            _aligned_free(pointer);
+#else
+            std::free(pointer);
+#endif
+        }
+    }
+
+    uint64_t AllocationCounter::GetThreadAllocationCount() {
+        return t_AllocationCount;
+    }
+}
+
+// The array and nothrow forms of the standard library call these ones.
+void* operator new(const size_t size) {
+    if (void* pointer = WGPURenderer::Allocate(size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment) {
+    if (void* pointer = WGPURenderer::AllocateAligned(size, alignment)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t /*size*/) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/) noexcept {
+    WGPURenderer::FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, size_t /*size*/, std::align_val_t /*alignment*/) noexcept {
+    WGPURenderer::FreeAligned(pointer);
+}
@@ -3,47 +3,277 @@
 // For conditions of distribution and use, see copyright notice in LICENSE.
 
 #include <WGPURenderer/Application.hpp>
+#include <WGPURenderer/AllocationCounter.hpp>
+#include <WGPURenderer/FrameArena.hpp>
+#include <WGPURenderer/FrameLimiter.hpp>
+#include <WGPURenderer/ImageWriter.hpp>
+#include <WGPURenderer/JobSystem.hpp>
+#include <WGPURenderer/Profiler.hpp>
 #include <WGPURenderer/ResourceManager.hpp>
 
 #include <webgpu/webgpu.hpp>
 
 #include <glfw3webgpu.h>
 
+#include <magic_enum.hpp>
+
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace WGPURenderer {
+    namespace {
+        // Matches ObjectUniforms in main.wgsl.
+        struct ObjectUniforms {
+            std::array<float, 2> offset;
+        };
+
+        // Room for a few thousand objects per frame in flight.
+        constexpr uint64_t ObjectUniformsFrameSize = 1 << 20;
+
+        // The offset that we want to apply to the logo.
+        constexpr std::array<float, 2> LogoOffset = {-0.6875f, -0.463f};
+
+        // Initial capacities of the mesh pool, which grows as needed.
+        constexpr uint32_t MeshPoolVertexCapacity = 1 << 16;
+        constexpr uint32_t MeshPoolIndexCapacity = 1 << 18;
+
+        // Radius of the circle around the origin that holds the mesh, once its positions are decoded and moved by
+        // `offset`.
+        float ComputeBoundingRadius(const Geometry& geometry, const std::array<float, 2>& offset) {
+            const PositionTransform& transform = geometry.GetPositionTransform();
+            float radius = 0.0f;
+            const auto addPoint = [&](const float x, const float y) {
+                const float movedX = x * transform.scale[0] + transform.offset[0] + offset[0];
+                const float movedY = y * transform.scale[1] + transform.offset[1] + offset[1];
+                radius = std::max(radius, std::sqrt(movedX * movedX + movedY * movedY));
+            };
+
+            // Quantized positions are normalized to the bounds of the mesh, the corners of the bounds are enough.
+            if (geometry.GetVertexEncoding() == VertexEncoding::Quantized) {
+                for (const float x : {-1.0f, 1.0f}) {
+                    for (const float y : {-1.0f, 1.0f}) {
+                        addPoint(x, y);
+                    }
+                }
+
+                return radius;
+            }
+
+            uint32_t positionOffset = 0;
+            for (const VertexLayoutAttribute& attribute : geometry.GetVertexLayout().GetAttributes()) {
+                if (attribute.semantic == VertexSemantic::Position) {
+                    break;
+                }
+
+                positionOffset += VertexLayout::GetEncodedSize(attribute, VertexEncoding::Float);
+            }
+
+            const std::span<const std::byte> vertexData = geometry.GetVertexData();
+            const size_t stride = geometry.GetVertexStride();
+            for (size_t vertex = 0; vertex < geometry.GetVertexCount(); ++vertex) {
+                std::array<float, 2> position;
+                std::memcpy(position.data(), vertexData.data() + vertex * stride + positionOffset, sizeof(position));
+                addPoint(position[0], position[1]);
+            }
+
+            return radius;
+        }
+
+        // report.json becomes report-1000.json for 1000 instances. Empty when there's no report.
+        std::filesystem::path GetSweepReportPath(const std::filesystem::path& reportPath,
+                                                 const uint32_t instanceCount) {
+            if (reportPath.empty()) {
+                return {};
+            }
+
+            std::filesystem::path sweepReportPath = reportPath;
+            sweepReportPath.replace_filename(reportPath.stem().string() + '-' + std::to_string(instanceCount) +
+                                             reportPath.extension().string());
+            return sweepReportPath;
+        }
+    }
+
+    Application::Application(ApplicationConfig config)
+        : m_Config(std::move(config)) {
+    }
 
     bool Application::Run() {
+        m_StartTime = std::chrono::steady_clock::now();
+        WR_PROFILE_THREAD("Main");
+
+        JobSystem::Initialize(m_Config.workerCount);
+
+        // Reading and parsing the assets doesn't need the device, so it overlaps with its creation.
+        StartLoadingAssets();
+
         if (!Initialize()) {
+            // The loading thread may still be using the job system.
+            if (m_AssetsLoaded.valid()) {
+                m_AssetsLoaded.wait();
+            }
+
+            JobSystem::Terminate();
             return false;
         }
 
-        while (!glfwWindowShouldClose(m_Window)) {
-            glfwPollEvents();
-            MainLoop();
+        bool success = true;
+        if (m_Config.instanceSweep.empty()) {
+            success = RenderFrames(m_Config.reportPath);
+        } else {
+            // Each count is a benchmark of its own, the device and the assets are shared.
+            for (const uint32_t instanceCount : m_Config.instanceSweep) {
+                if (!m_Config.headless && glfwWindowShouldClose(m_Window)) {
+                    break;
+                }
+
+                std::cout << "Benchmarking " << instanceCount << " instances\n";
+                InitializeInstances(instanceCount);
+                success = RenderFrames(GetSweepReportPath(m_Config.reportPath, instanceCount)) && success;
+            }
+        }
+
+        if (m_Config.headless && !m_Config.outputPath.empty()) {
+            success = SaveOffscreenTarget(m_Config.outputPath) && success;
         }
 
         Terminate();
+        JobSystem::Terminate();
 
-        return true;
+#ifdef WR_PROFILING
+        if (!Profiler::WriteChromeTrace(m_Config.tracePath)) {
+            std::cerr << "Couldn't write the trace to " << m_Config.tracePath << "!\n";
+        } else {
+            std::cout << "Wrote the trace to " << m_Config.tracePath << '\n';
+        }
+#endif
+
+        return success;
     }
 
-    bool Application::Initialize() {
-        if (!glfwInit()) {
-            std::cerr << "Couldn't initialize GLFW!\n";
-            return false;
+    bool Application::RenderFrames(const std::filesystem::path& reportPath) {
+        // A frame count of 0 renders until the window is closed.
+        const uint32_t warmupFrameCount = m_Config.benchmark ? m_Config.warmupFrameCount : 0;
+        const uint32_t measuredFrameCount = m_Config.GetFrameCount();
+        const uint64_t frameCount = measuredFrameCount != 0 ? uint64_t{warmupFrameCount} + measuredFrameCount : 0;
+
+        Benchmark benchmark(m_Config.benchmark ? measuredFrameCount : 0);
+        FrameLimiter frameLimiter(m_Config.maxFrameRate);
+        auto measureStart = std::chrono::steady_clock::now();
+
+        // Transient data of the frame, so that steady-state frames don't allocate from the heap.
+        FrameArena frameArena;
+
+        // The GPU timings of a frame are read back a few frames later.
+        uint64_t firstMeasuredGpuFrame = 0;
+        const auto collectGpuFrames = [&] {
+            std::pmr::vector<GpuTimer::FrameTiming> gpuFrames(&frameArena);
+            m_GpuTimer.Update(gpuFrames);
+            for (const GpuTimer::FrameTiming& gpuFrame : gpuFrames) {
+                if (m_Config.benchmark && gpuFrame.frameIndex >= firstMeasuredGpuFrame) {
+                    benchmark.AddGpuFrame(gpuFrame.duration);
+                }
+            }
+        };
+
+        for (uint64_t frame = 0; frameCount == 0 || frame < frameCount; ++frame) {
+            const auto frameStart = std::chrono::steady_clock::now();
+            const uint64_t frameStartAllocationCount = AllocationCounter::GetThreadAllocationCount();
+            frameArena.Reset();
+            if (frame == warmupFrameCount) {
+                measureStart = frameStart;
+                firstMeasuredGpuFrame = m_GpuTimer.GetFrameIndex();
+            }
+
+            // Pacing comes before polling the input, so that the frame starts from the most recent input.
+            FrameTimings timings;
+            frameLimiter.Wait();
+            if (m_Config.lowLatency) {
+                m_FrameRing.WaitForAll();
+            }
+            timings.pacing = GetElapsedMilliseconds(frameStart);
+
+            if (!m_Config.headless) {
+                if (glfwWindowShouldClose(m_Window)) {
+                    break;
+                }
+
+                glfwPollEvents();
+
+                // A minimized window has nothing to render to until it is restored.
+                while ((m_FramebufferWidth == 0 || m_FramebufferHeight == 0) && !glfwWindowShouldClose(m_Window)) {
+                    glfwWaitEvents();
+                }
+            }
+
+            MainLoop(timings);
+            timings.frame = GetElapsedMilliseconds(frameStart);
+            timings.heapAllocationCount =
+                static_cast<uint32_t>(AllocationCounter::GetThreadAllocationCount() - frameStartAllocationCount);
+
+            if (!m_FirstFrameRendered) {
+                m_FirstFrameRendered = true;
+                std::cout << "Time to first frame: " << GetElapsedMilliseconds(m_StartTime) << " ms\n";
+            }
+
+            if (m_Config.benchmark && frame >= warmupFrameCount) {
+                benchmark.AddFrame(timings);
+            }
+
+            collectGpuFrames();
         }
 
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        if (!m_Config.benchmark) {
+            return true;
+        }
 
-        m_Window = glfwCreateWindow(640, 480, "WebGPU Renderer", nullptr, nullptr);
+        // Wait for the GPU to finish the measured frames, so that the total time doesn't only reflect how fast the
+        // CPU submits them.
+        m_Device.poll(true);
+        benchmark.SetTotalTime(GetElapsedMilliseconds(measureStart));
+        collectGpuFrames();
+        return ReportBenchmark(benchmark, reportPath);
+    }
 
-        if (!m_Window) {
-            std::cerr << "Couldn't create GLFW window!\n";
-            glfwTerminate();
-            return false;
+    bool Application::Initialize() {
+        WR_PROFILE_SCOPE("Application::Initialize");
+
+        // Headless runs never touch GLFW, so that they work on machines without any display.
+        if (!m_Config.headless) {
+            if (!glfwInit()) {
+                std::cerr << "Couldn't initialize GLFW!\n";
+                return false;
+            }
+
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+
+            m_Window = glfwCreateWindow(static_cast<int>(m_Config.width), static_cast<int>(m_Config.height),
+                                        "WebGPU Renderer", nullptr, nullptr);
+
+            if (!m_Window) {
+                std::cerr << "Couldn't create GLFW window!\n";
+                glfwTerminate();
+                return false;
+            }
+
+            // The framebuffer can be larger than the window on high DPI displays, the surface must match it.
+            int framebufferWidth;
+            int framebufferHeight;
+            glfwGetFramebufferSize(m_Window, &framebufferWidth, &framebufferHeight);
+            m_FramebufferWidth = static_cast<uint32_t>(framebufferWidth);
+            m_FramebufferHeight = static_cast<uint32_t>(framebufferHeight);
+
+            glfwSetWindowUserPointer(m_Window, this);
+            glfwSetFramebufferSizeCallback(m_Window, OnFramebufferResized);
         }
 
         wgpu::Instance instance = wgpuCreateInstance(nullptr);
@@ -53,16 +283,21 @@ namespace WGPURenderer {
             return false;
         }
 
-        m_Surface = glfwGetWGPUSurface(instance, m_Window);
+        if (!m_Config.headless) {
+            m_Surface = glfwGetWGPUSurface(instance, m_Window);
 
-        if (!m_Surface) {
-            std::cerr << "Couldn't get WebGPU surface!\n";
-            return false;
+            if (!m_Surface) {
+                std::cerr << "Couldn't get WebGPU surface!\n";
+                return false;
+            }
         }
 
         wgpu::RequestAdapterOptions adapterOptions{};
         adapterOptions.nextInChain = nullptr;
         adapterOptions.compatibleSurface = m_Surface;
+        adapterOptions.powerPreference = wgpu::PowerPreference::Undefined;
+        adapterOptions.backendType = wgpu::BackendType::Undefined;
+        adapterOptions.forceFallbackAdapter = m_Config.forceFallbackAdapter;
         wgpu::Adapter adapter = instance.requestAdapter(adapterOptions);
 
         if (!adapter) {
@@ -73,6 +308,12 @@ namespace WGPURenderer {
         // Release the instance since we don't need it after we've got the adapter.
         instance.release();
 
+        wgpu::AdapterProperties adapterProperties{};
+        adapter.getProperties(&adapterProperties);
+        m_AdapterName = adapterProperties.name ? adapterProperties.name : "";
+        m_BackendName = magic_enum::enum_name(static_cast<WGPUBackendType>(adapterProperties.backendType));
+        std::cout << "Using adapter " << m_AdapterName << " (" << m_BackendName << ")\n";
+
         wgpu::DeviceDescriptor deviceDesc{};
         deviceDesc.nextInChain = nullptr;
 
@@ -82,8 +323,12 @@ namespace WGPURenderer {
         deviceDesc.label = nullptr;
 #endif
 
-        deviceDesc.requiredFeatureCount = 0;
-        deviceDesc.requiredFeatures = nullptr;
+        // GPU timings need timestamp queries, without them only the CPU timings are measured.
+        const bool timestampQuerySupported = adapter.hasFeature(wgpu::FeatureName::TimestampQuery);
+        const WGPUFeatureName timestampQueryFeature = WGPUFeatureName_TimestampQuery;
+
+        deviceDesc.requiredFeatureCount = timestampQuerySupported ? 1 : 0;
+        deviceDesc.requiredFeatures = timestampQuerySupported ? &timestampQueryFeature : nullptr;
         deviceDesc.requiredLimits = nullptr;
 
         deviceDesc.defaultQueue.nextInChain = nullptr;
@@ -123,137 +368,221 @@ namespace WGPURenderer {
 
 
         m_Queue = m_Device.getQueue();
+        m_FrameRing.Initialize(m_Device, m_Queue, m_Config.framesInFlight);
 
-        // Configure the surface
-        wgpu::SurfaceConfiguration surfaceConfiguration;
-        surfaceConfiguration.nextInChain = nullptr;
-        surfaceConfiguration.width = 640;
-        surfaceConfiguration.height = 480;
+        if (!timestampQuerySupported || !m_GpuTimer.Initialize(m_Device)) {
+            std::cout << "GPU timestamp queries aren't available, only CPU timings will be measured\n";
+        }
 
-        m_SurfaceFormat = m_Surface.getPreferredFormat(adapter);
-        surfaceConfiguration.format = m_SurfaceFormat;
+        if (m_Config.headless) {
+            if (!InitializeOffscreenTarget()) {
+                std::cerr << "Failed to initialize offscreen target!\n";
+                return false;
+            }
+        } else {
+            // Configure the surface
+            m_TargetWidth = m_FramebufferWidth;
+            m_TargetHeight = m_FramebufferHeight;
 
-        // We don't need any particular view format
-        surfaceConfiguration.viewFormatCount = 0;
-        surfaceConfiguration.viewFormats = nullptr;
+            m_SurfaceConfiguration.nextInChain = nullptr;
+            m_SurfaceConfiguration.width = m_TargetWidth;
+            m_SurfaceConfiguration.height = m_TargetHeight;
 
-        surfaceConfiguration.usage = wgpu::TextureUsage::RenderAttachment;
+            m_SurfaceFormat = m_Surface.getPreferredFormat(adapter);
+            m_SurfaceConfiguration.format = m_SurfaceFormat;
 
-        surfaceConfiguration.device = m_Device;
+            // We don't need any particular view format
+            m_SurfaceConfiguration.viewFormatCount = 0;
+            m_SurfaceConfiguration.viewFormats = nullptr;
 
-        surfaceConfiguration.presentMode = wgpu::PresentMode::Fifo;
+            m_SurfaceConfiguration.usage = wgpu::TextureUsage::RenderAttachment;
 
-        surfaceConfiguration.alphaMode = wgpu::CompositeAlphaMode::Auto;
+            m_SurfaceConfiguration.device = m_Device;
 
-        m_Surface.configure(surfaceConfiguration);
+            m_PresentMode = SelectPresentMode(adapter);
+            m_SurfaceConfiguration.presentMode = m_PresentMode;
 
-        adapter.release();
+            m_SurfaceConfiguration.alphaMode = wgpu::CompositeAlphaMode::Auto;
 
-        if (!InitializePipeline()) {
-            std::cerr << "Failed to initialize pipeline!\n";
-            return false;
+            m_Surface.configure(m_SurfaceConfiguration);
         }
 
+        // Only the offscreen texture is the same object from a frame to the next, the surface returns a new texture
+        // every frame.
+        m_FrameContext.Initialize(m_SurfaceFormat, m_Config.cacheTargetViews && m_Config.headless);
+
+        adapter.release();
+
+        // The buffers come first since the pipeline's vertex layout depends on how the geometry is encoded.
         if (!InitializeBuffers()) {
             std::cerr << "Failed to initialize buffers!\n";
             return false;
         }
 
+        if (!InitializePipeline()) {
+            std::cerr << "Failed to initialize pipeline!\n";
+            return false;
+        }
+
         return true;
     }
 
-    void Application::MainLoop() {
-        // Get the next target texture view.
-        wgpu::TextureView targetView = GetNextSurfaceTextureView();
+    void Application::MainLoop(FrameTimings& timings) {
+        WR_PROFILE_SCOPE("Application::MainLoop");
+
+        auto phaseStart = std::chrono::steady_clock::now();
+        const auto endPhase = [&phaseStart](double& phaseTime) {
+            const auto now = std::chrono::steady_clock::now();
+            phaseTime = std::chrono::duration<double, std::milli>(now - phaseStart).count();
+            phaseStart = now;
+        };
+
+        // Bound how far the CPU runs ahead, so that the slot's per-frame resources are free to be written again.
+        const uint32_t frameSlot = m_FrameRing.BeginFrame();
+        timings.inFlightCount = m_FrameRing.GetInFlightCount();
+        // The resources destroyed the last time the slot was used aren't referenced by any frame in flight anymore.
+        m_Resources.BeginFrame(frameSlot);
+        endPhase(timings.wait);
+
+        if (!m_Config.headless && !UpdateSurfaceSize()) {
+            return;
+        }
+
+        // Get the view of the next target texture, the frame context keeps the offscreen texture's one.
+        const wgpu::Texture targetTexture = m_Config.headless ? m_Resources.Get(m_OffscreenTexture)
+                                                              : GetNextSurfaceTexture();
+        const wgpu::TextureView targetView = targetTexture ? m_FrameContext.AcquireTargetView(targetTexture)
+                                                           : nullptr;
+        endPhase(timings.acquire);
         if (!targetView) {
             return;
         }
 
-        wgpu::CommandEncoderDescriptor encoderDesc;
-        encoderDesc.nextInChain = nullptr;
-#ifdef WR_DEBUG
-        encoderDesc.label = "Main command encoder";
-#else
-        encoderDesc.label = nullptr;
-#endif
+        // The per-object constants of the frame are gathered in the slot's region of the uniform ring.
+        m_UniformRing.BeginFrame(frameSlot);
 
-        // Create an encoder to register our commands.
-        wgpu::CommandEncoder encoder = m_Device.createCommandEncoder(encoderDesc);
+        // Past this point the frame always runs to its end, so that the target is presented and its view released. A
+        // failure only skips the draw.
+        bool drawMesh = m_Instances.Upload(m_Device, m_StagingBelt);
+        if (!drawMesh) {
+            std::cerr << "Couldn't create the instance buffer!\n";
+        }
 
-        // Describe and create a render pass encoder from the command encoder.
-        wgpu::RenderPassDescriptor renderPassDesc{};
-        renderPassDesc.nextInChain = nullptr;
-#ifdef WR_DEBUG
-        renderPassDesc.label = "Main render pass";
-#else
-        renderPassDesc.label = nullptr;
-#endif
+        ObjectUniforms objectUniforms{};
+        objectUniforms.offset = LogoOffset;
 
-        wgpu::RenderPassColorAttachment renderPassColorAttachment;
-        renderPassColorAttachment.nextInChain = nullptr;
-        renderPassColorAttachment.view = targetView;
-        renderPassColorAttachment.resolveTarget = nullptr;
-        renderPassColorAttachment.loadOp = wgpu::LoadOp::Clear;
-        renderPassColorAttachment.storeOp = wgpu::StoreOp::Store;
-        renderPassColorAttachment.clearValue = wgpu::Color{0.01, 0.01, 0.01, 1.0};
+        uint32_t objectOffset = 0;
+        if (drawMesh && !m_UniformRing.Allocate(objectUniforms, objectOffset)) {
+            std::cerr << "The uniform ring is full!\n";
+            drawMesh = false;
+        }
 
-        renderPassDesc.colorAttachmentCount = 1;
-        renderPassDesc.colorAttachments = &renderPassColorAttachment;
-        renderPassDesc.depthStencilAttachment = nullptr;
-        renderPassDesc.timestampWrites = nullptr;
+        // Create an encoder to register our commands.
+        wgpu::CommandEncoder encoder = m_Device.createCommandEncoder(m_FrameContext.GetEncoderDescriptor());
 
-        // Create the render pass encoder
-        wgpu::RenderPassEncoder renderPass = encoder.beginRenderPass(renderPassDesc);
+        // The staged uploads are copied first, every pass of the frame sees them.
+        m_StagingBelt.Finish(encoder);
 
-        renderPass.setPipeline(m_Pipeline);
+        const MeshRange mesh = m_MeshPool.GetMeshRange(m_Mesh);
 
-        renderPass.setVertexBuffer(0, m_PointBuffer, 0, m_PointBuffer.getSize());
-        renderPass.setIndexBuffer(m_IndexBuffer, wgpu::IndexFormat::Uint16, 0, m_IndexBuffer.getSize());
+        // Culling runs before the render pass, which consumes its results.
+        if (drawMesh && m_Config.drawMode != DrawMode::Direct) {
+            const float aspectRatio = static_cast<float>(m_TargetWidth) / static_cast<float>(m_TargetHeight);
+            if (!m_IndirectDraw.Prepare(encoder, m_Instances, mesh, m_MeshRadius, aspectRatio)) {
+                std::cerr << "Couldn't prepare the indirect draw!\n";
+                drawMesh = false;
+            }
+        }
 
-        renderPass.drawIndexed(m_IndexCount, 1, 0, 0, 0);
+        // Create the render pass encoder, only the target and the timestamp writes change from a frame to the next.
+        wgpu::RenderPassEncoder renderPass = encoder.beginRenderPass(
+            m_FrameContext.GetRenderPassDescriptor(targetView, m_GpuTimer.BeginPass("Main render pass")));
+
+        // The pass still clears the target when the draw is skipped.
+        if (drawMesh) {
+            renderPass.setPipeline(m_Resources.Get(m_Pipeline));
+            renderPass.setBindGroup(0, m_Resources.Get(m_MeshBindGroup), 0, nullptr);
+            renderPass.setBindGroup(1, m_Resources.Get(m_ObjectBindGroup), 1, &objectOffset);
+
+            // Every mesh of the pool is drawn from the same bindings.
+            m_MeshPool.Bind(renderPass);
+
+            // Every copy of the mesh in a single draw call. Indirect draws take their instance count from the GPU, so
+            // the CPU cost doesn't depend on the number of objects.
+            if (m_Config.drawMode == DrawMode::Direct) {
+                renderPass.setVertexBuffer(1, m_Instances.GetBuffer(), 0, m_Instances.GetSize());
+                renderPass.drawIndexed(mesh.indexCount, m_Instances.GetUploadedCount(), mesh.firstIndex,
+                                       mesh.baseVertex, 0);
+            } else {
+                m_IndirectDraw.Draw(renderPass, m_Instances);
+            }
+        }
 
         // Release the render pass encoder when we're done using it.
         renderPass.end();
         renderPass.release();
 
-        // Describe and build a command buffer from the encoder's registered commands.
-        wgpu::CommandBufferDescriptor cmdBufferDesc;
-        cmdBufferDesc.nextInChain = nullptr;
-#ifdef WR_DEBUG
-        cmdBufferDesc.label = "Main command buffer";
-#else
-        cmdBufferDesc.label = nullptr;
-#endif
+        m_GpuTimer.ResolveFrame(encoder);
 
-        wgpu::CommandBuffer cmdBuffer = encoder.finish(cmdBufferDesc);
+        wgpu::CommandBuffer cmdBuffer = encoder.finish(m_FrameContext.GetCommandBufferDescriptor());
         encoder.release();
 
+        // A single upload for all the objects of the frame, ordered before the submission that reads it.
+        m_UniformRing.EndFrame(m_Queue);
+        endPhase(timings.encode);
+
         // Submit the command buffer to the GPU and release it.
-        m_Queue.submit(1, &cmdBuffer);
+        {
+            WR_PROFILE_SCOPE("Queue::submit");
+            m_FrameRing.EndFrame(m_Queue.submitForIndex(1, &cmdBuffer));
+        }
         cmdBuffer.release();
+        m_StagingBelt.Recall();
+        m_GpuTimer.EndFrame();
+        endPhase(timings.submit);
 
-        // Release the surface texture view. 
-        targetView.release();
+        // A cached view is kept for the next frames, which render to the same texture.
+        m_FrameContext.ReleaseTargetView(targetView);
 
         // Present the surface.
-        m_Surface.present();
+        if (!m_Config.headless) {
+            WR_PROFILE_SCOPE("Surface::present");
+            m_Surface.present();
+        }
 
-        m_Device.poll(false);
+        {
+            WR_PROFILE_SCOPE("Device::poll");
+            m_Device.poll(false);
+        }
+        endPhase(timings.present);
     }
 
     void Application::Terminate() {
-        m_IndexBuffer.release();
-        m_PointBuffer.release();
-        m_Pipeline.release();
-        m_Surface.unconfigure();
+        m_FrameRing.Terminate();
+        m_FrameContext.Reset();
+        m_GpuTimer.Terminate();
+        // The frame ring waited for the GPU, so the registry's resources are released right away.
+        m_Resources.Terminate();
+        m_UniformRing.Terminate();
+        m_StagingBelt.Terminate();
+        m_IndirectDraw.Terminate();
+        m_Instances.Terminate();
+        m_MeshPool.Terminate();
+        if (!m_Config.headless) {
+            m_Surface.unconfigure();
+        }
         m_Queue.release();
         m_Device.release();
-        m_Surface.release();
-        glfwDestroyWindow(m_Window);
-        glfwTerminate();
+        if (!m_Config.headless) {
+            m_Surface.release();
+            glfwDestroyWindow(m_Window);
+            glfwTerminate();
+        }
     }
 
     bool Application::InitializePipeline() {
+        WR_PROFILE_SCOPE("Application::InitializePipeline");
+
         wgpu::ShaderModule shaderModule = ResourceManager::LoadShaderModule("main.wgsl", m_Device);
 
         if (!shaderModule) {
@@ -263,27 +592,38 @@ namespace WGPURenderer {
 
         wgpu::RenderPipelineDescriptor pipelineDesc{};
 
-        wgpu::VertexBufferLayout vertexBufferLayout;
-
-        std::array<wgpu::VertexAttribute, 2> vertexAttributes{};
-        // Position attribute
-        vertexAttributes[0].shaderLocation = 0;
-        vertexAttributes[0].format = wgpu::VertexFormat::Float32x2;
-        vertexAttributes[0].offset = 0;
+        // main.wgsl reads the position and the color, the other attributes of the model are skipped over.
+        if (!m_VertexLayout.HasAttribute(VertexSemantic::Position) ||
+            !m_VertexLayout.HasAttribute(VertexSemantic::Color)) {
+            std::cerr << "The geometry doesn't have the attributes required by the shader!\n";
+            shaderModule.release();
+            return false;
+        }
 
-        // Color attribute
-        vertexAttributes[1].shaderLocation = 1;
-        vertexAttributes[1].format = wgpu::VertexFormat::Float32x3;
-        vertexAttributes[1].offset = 2 * sizeof(float);
+        std::array<wgpu::VertexBufferLayout, 2> vertexBufferLayouts;
+        wgpu::VertexBufferLayout& vertexBufferLayout = vertexBufferLayouts[0];
 
-        vertexBufferLayout.attributeCount = vertexAttributes.size();
+        // The formats and offsets come from the layout declared by the model. Quantized positions are normalized to
+        // the mesh bounds, the shader maps them back with the mesh uniforms.
+        std::array<wgpu::VertexAttribute, VertexLayout::MaxAttributeCount> vertexAttributes{};
+        vertexBufferLayout.attributeCount = m_VertexLayout.BuildVertexAttributes(m_VertexEncoding, vertexAttributes);
         vertexBufferLayout.attributes = vertexAttributes.data();
 
-        vertexBufferLayout.arrayStride = 5ull * sizeof(float);
+        vertexBufferLayout.arrayStride = m_VertexLayout.GetStride(m_VertexEncoding);
         vertexBufferLayout.stepMode = wgpu::VertexStepMode::Vertex;
 
-        pipelineDesc.vertex.bufferCount = 1;
-        pipelineDesc.vertex.buffers = &vertexBufferLayout;
+        // The second buffer advances once per instance.
+        std::array<wgpu::VertexAttribute, InstanceBuffer::AttributeCount> instanceAttributes{};
+        InstanceBuffer::BuildVertexAttributes(instanceAttributes);
+
+        wgpu::VertexBufferLayout& instanceBufferLayout = vertexBufferLayouts[1];
+        instanceBufferLayout.attributeCount = instanceAttributes.size();
+        instanceBufferLayout.attributes = instanceAttributes.data();
+        instanceBufferLayout.arrayStride = sizeof(InstanceData);
+        instanceBufferLayout.stepMode = wgpu::VertexStepMode::Instance;
+
+        pipelineDesc.vertex.bufferCount = vertexBufferLayouts.size();
+        pipelineDesc.vertex.buffers = vertexBufferLayouts.data();
 
         pipelineDesc.vertex.module = shaderModule;
         pipelineDesc.vertex.entryPoint = "vs_main";
@@ -345,75 +685,516 @@ namespace WGPURenderer {
         // Default value as well (irrelevant for count = 1 anyway)
         pipelineDesc.multisample.alphaToCoverageEnabled = false;
 
-        pipelineDesc.layout = nullptr;
+        // The layout is explicit since layouts deduced from the shader can't have dynamic offsets. Group 0 holds the
+        // uniforms that rarely change, group 1 the per-object uniforms of the ring.
+        wgpu::Buffer meshUniformBuffer = m_Resources.Get(m_MeshUniformBuffer);
+        wgpu::Buffer viewUniformBuffer = m_Resources.Get(m_ViewUniformBuffer);
+
+        std::array<wgpu::BindGroupLayoutEntry, 2> meshLayoutEntries{};
+        meshLayoutEntries[0].binding = 0;
+        meshLayoutEntries[0].visibility = wgpu::ShaderStage::Vertex;
+        meshLayoutEntries[0].buffer.type = wgpu::BufferBindingType::Uniform;
+        meshLayoutEntries[0].buffer.hasDynamicOffset = false;
+        meshLayoutEntries[0].buffer.minBindingSize = meshUniformBuffer.getSize();
+
+        meshLayoutEntries[1].binding = 1;
+        meshLayoutEntries[1].visibility = wgpu::ShaderStage::Vertex;
+        meshLayoutEntries[1].buffer.type = wgpu::BufferBindingType::Uniform;
+        meshLayoutEntries[1].buffer.hasDynamicOffset = false;
+        meshLayoutEntries[1].buffer.minBindingSize = viewUniformBuffer.getSize();
+
+        wgpu::BindGroupLayoutEntry objectLayoutEntry{};
+        objectLayoutEntry.binding = 0;
+        objectLayoutEntry.visibility = wgpu::ShaderStage::Vertex;
+        objectLayoutEntry.buffer.type = wgpu::BufferBindingType::Uniform;
+        objectLayoutEntry.buffer.hasDynamicOffset = true;
+        objectLayoutEntry.buffer.minBindingSize = sizeof(ObjectUniforms);
+
+        wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc{};
+        bindGroupLayoutDesc.entryCount = meshLayoutEntries.size();
+        bindGroupLayoutDesc.entries = meshLayoutEntries.data();
+        wgpu::BindGroupLayout meshBindGroupLayout = m_Device.createBindGroupLayout(bindGroupLayoutDesc);
+
+        bindGroupLayoutDesc.entryCount = 1;
+        bindGroupLayoutDesc.entries = &objectLayoutEntry;
+        wgpu::BindGroupLayout objectBindGroupLayout = m_Device.createBindGroupLayout(bindGroupLayoutDesc);
+
+        const std::array<WGPUBindGroupLayout, 2> bindGroupLayouts = {meshBindGroupLayout, objectBindGroupLayout};
+
+        wgpu::PipelineLayoutDescriptor pipelineLayoutDesc{};
+        pipelineLayoutDesc.bindGroupLayoutCount = bindGroupLayouts.size();
+        pipelineLayoutDesc.bindGroupLayouts = bindGroupLayouts.data();
+        wgpu::PipelineLayout pipelineLayout = m_Device.createPipelineLayout(pipelineLayoutDesc);
 
-        m_Pipeline = m_Device.createRenderPipeline(pipelineDesc);
+        pipelineDesc.layout = pipelineLayout;
+
+        m_Pipeline = m_Resources.Add(m_Device.createRenderPipeline(pipelineDesc));
+
+        pipelineLayout.release();
 
         if (!m_Pipeline) {
             std::cerr << "Failed to create render pipeline!\n";
+            meshBindGroupLayout.release();
+            objectBindGroupLayout.release();
+            return false;
+        }
+
+        std::array<wgpu::BindGroupEntry, 2> bindings{};
+        bindings[0].binding = 0;
+        bindings[0].buffer = meshUniformBuffer;
+        bindings[0].offset = 0;
+        bindings[0].size = meshUniformBuffer.getSize();
+
+        // The view uniforms are rewritten in place on resize, so the bind group never needs to be recreated.
+        bindings[1].binding = 1;
+        bindings[1].buffer = viewUniformBuffer;
+        bindings[1].offset = 0;
+        bindings[1].size = viewUniformBuffer.getSize();
+
+        wgpu::BindGroupDescriptor bindGroupDesc{};
+        bindGroupDesc.layout = meshBindGroupLayout;
+        bindGroupDesc.entryCount = bindings.size();
+        bindGroupDesc.entries = bindings.data();
+        m_MeshBindGroup = m_Resources.Add(m_Device.createBindGroup(bindGroupDesc));
+
+        // The binding covers a single slice, the dynamic offset selects which one.
+        wgpu::BindGroupEntry objectBinding{};
+        objectBinding.binding = 0;
+        objectBinding.buffer = m_UniformRing.GetBuffer();
+        objectBinding.offset = 0;
+        objectBinding.size = sizeof(ObjectUniforms);
+
+        bindGroupDesc.layout = objectBindGroupLayout;
+        bindGroupDesc.entryCount = 1;
+        bindGroupDesc.entries = &objectBinding;
+        m_ObjectBindGroup = m_Resources.Add(m_Device.createBindGroup(bindGroupDesc));
+
+        meshBindGroupLayout.release();
+        objectBindGroupLayout.release();
+
+        if (!m_MeshBindGroup || !m_ObjectBindGroup) {
+            std::cerr << "Failed to create bind groups!\n";
             return false;
         }
 
         return true;
     }
 
+    void Application::StartLoadingAssets() {
+        m_AssetsLoaded = std::async(std::launch::async, [this] {
+            WR_PROFILE_THREAD("Asset loader");
+            const auto loadStart = std::chrono::steady_clock::now();
+
+            // The logo's colors are 8-bit anyway and its position error is far below a pixel.
+            const bool loaded = ResourceManager::LoadGeometry("webgpu.txt", m_Geometry, VertexEncoding::Quantized);
+
+            m_AssetLoadTime = GetElapsedMilliseconds(loadStart);
+            return loaded;
+        });
+    }
+
     bool Application::InitializeBuffers() {
-        std::vector<float> pointData;
-        std::vector<uint16_t> indexData;
+        WR_PROFILE_SCOPE("Application::InitializeBuffers");
+
+        // Any time spent waiting here is loading time that the device creation didn't hide.
+        const auto waitStart = std::chrono::steady_clock::now();
+        bool loaded;
+        {
+            WR_PROFILE_SCOPE("Wait for assets");
+            loaded = m_AssetsLoaded.get();
+        }
+        std::cout << "Loaded assets in " << m_AssetLoadTime << " ms, waited " << GetElapsedMilliseconds(waitStart)
+                  << " ms for them after the device creation\n";
 
         // Check for errors
-        if (!ResourceManager::LoadGeometry("webgpu.txt", pointData, indexData)) {
+        if (!loaded) {
             std::cerr << "Couldn't load geometry!\n";
             return false;
         }
 
-        m_IndexCount = static_cast<uint32_t>(indexData.size());
+        const Geometry& geometry = m_Geometry;
+
+        m_VertexEncoding = geometry.GetVertexEncoding();
+        m_VertexLayout = geometry.GetVertexLayout();
+
+        // Meshes with the same layout share the pool's buffers. With baseVertex, indices are relative to their mesh,
+        // so 16-bit pools hold any mesh of up to 65536 vertices.
+        if (!m_MeshPool.Initialize(m_Device, m_Queue, static_cast<uint32_t>(geometry.GetVertexStride()),
+                                   geometry.GetIndexFormat(), MeshPoolVertexCapacity, MeshPoolIndexCapacity)) {
+            std::cerr << "Couldn't create the mesh pool!\n";
+            return false;
+        }
+
+        // The spans may point straight into the mapped geometry cache, they are uploaded without any copy.
+        m_Mesh = m_MeshPool.AddMesh(geometry);
+        if (m_Mesh == InvalidMesh) {
+            std::cerr << "Couldn't upload the mesh!\n";
+            return false;
+        }
+
+        const MeshPoolStatistics meshPoolStatistics = m_MeshPool.GetStatistics();
+        std::cout << "Mesh pool: " << meshPoolStatistics.meshCount << " meshes, "
+                  << meshPoolStatistics.vertices.GetOccupancy() * 100.0f << "% of the vertices and "
+                  << meshPoolStatistics.indices.GetOccupancy() * 100.0f << "% of the indices used\n";
 
-        // Create vertex buffer
         wgpu::BufferDescriptor bufferDesc{};
-        bufferDesc.size = pointData.size() * sizeof(float);
-        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex;
         bufferDesc.mappedAtCreation = false;
-        m_PointBuffer = m_Device.createBuffer(bufferDesc);
 
-        m_Queue.writeBuffer(m_PointBuffer, 0, pointData.data(), bufferDesc.size);
+        // Create mesh uniform buffer
+        const PositionTransform& positionTransform = geometry.GetPositionTransform();
+        // vec3f members are aligned on 16 bytes in WGSL.
+        const std::array<float, 8> meshUniforms = {
+            positionTransform.scale[0], positionTransform.scale[1], positionTransform.scale[2], 0.0f,
+            positionTransform.offset[0], positionTransform.offset[1], positionTransform.offset[2], 0.0f,
+        };
+
+        bufferDesc.size = sizeof(meshUniforms);
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform;
+        m_MeshUniformBuffer = m_Resources.Add(m_Device.createBuffer(bufferDesc));
+        if (!m_MeshUniformBuffer) {
+            std::cerr << "Couldn't create the mesh uniform buffer!\n";
+            return false;
+        }
+
+        m_Queue.writeBuffer(m_Resources.Get(m_MeshUniformBuffer), 0, meshUniforms.data(), bufferDesc.size);
+
+        // Create view uniform buffer, 16 bytes being the smallest size uniform buffers are laid out with.
+        bufferDesc.size = 4 * sizeof(float);
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform;
+        m_ViewUniformBuffer = m_Resources.Add(m_Device.createBuffer(bufferDesc));
+        if (!m_ViewUniformBuffer) {
+            std::cerr << "Couldn't create the view uniform buffer!\n";
+            return false;
+        }
 
-        // Create index buffer
-        bufferDesc.size = indexData.size() * sizeof(uint16_t);
-        bufferDesc.size = (bufferDesc.size + 3) & ~3; // round up to the next multiple of 4
-        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Index;
-        m_IndexBuffer = m_Device.createBuffer(bufferDesc);
+        UpdateViewUniforms();
+
+        if (!m_UniformRing.Initialize(m_Device, m_FrameRing.GetFramesInFlight(), ObjectUniformsFrameSize)) {
+            std::cerr << "Couldn't create the uniform ring!\n";
+            return false;
+        }
+
+        const uint64_t uploadBudget = static_cast<uint64_t>(m_Config.uploadBudget) * 1024;
+        m_StagingBelt.Initialize(m_Device, StagingBelt::DefaultChunkSize, uploadBudget);
+        InitializeInstances(m_Config.instanceCount);
+
+        m_MeshRadius = ComputeBoundingRadius(geometry, LogoOffset);
+
+        if (m_Config.drawMode != DrawMode::Direct &&
+            !m_IndirectDraw.Initialize(m_Device, m_Queue, m_Config.drawMode == DrawMode::GpuCulling)) {
+            std::cerr << "Couldn't initialize indirect draws!\n";
+            return false;
+        }
 
-        m_Queue.writeBuffer(m_IndexBuffer, 0, indexData.data(), bufferDesc.size);
+        // writeBuffer copies the data, the CPU side copy of the geometry isn't needed anymore.
+        m_Geometry = Geometry{};
 
         return true;
     }
 
-    wgpu::TextureView Application::GetNextSurfaceTextureView() {
+    void Application::InitializeInstances(const uint32_t instanceCount) {
+        m_Instances.Clear();
+
+        if (instanceCount == 1) {
+            m_Instances.AddInstance(InstanceData{});
+            return;
+        }
+
+        // Cells of the grid span [-1, 1], the copies leave a small gap between them.
+        const auto columnCount = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+        const float cellSize = 2.0f / static_cast<float>(columnCount);
+
+        for (uint32_t i = 0; i < instanceCount; ++i) {
+            const uint32_t column = i % columnCount;
+            const uint32_t row = i / columnCount;
+
+            InstanceData instance;
+            instance.offset = {
+                -1.0f + (static_cast<float>(column) + 0.5f) * cellSize,
+                1.0f - (static_cast<float>(row) + 0.5f) * cellSize,
+            };
+            instance.scale = 0.45f * cellSize;
+            instance.rotation = static_cast<float>(i % 16) * 0.1f;
+            // Tints spread over the instances, opaque.
+            instance.color = (i * 2654435761u) | 0xFF000000u;
+
+            m_Instances.AddInstance(instance);
+        }
+    }
+
+    bool Application::ReportBenchmark(const Benchmark& benchmark, const std::filesystem::path& reportPath) const {
+        const uint32_t expectedFrameCount = m_Config.GetFrameCount();
+        if (benchmark.GetFrameCount() < expectedFrameCount) {
+            std::cerr << "The window was closed after " << benchmark.GetFrameCount() << " of the "
+                      << expectedFrameCount << " measured frames!\n";
+        }
+
+        benchmark.PrintSummary();
+
+        bool success = true;
+        if (m_Config.requireNoAllocations && benchmark.GetMaxHeapAllocationCount() > 0) {
+            std::cerr << "A measured frame made " << benchmark.GetMaxHeapAllocationCount()
+                      << " heap allocations, expected none!\n";
+            success = false;
+        }
+
+        if (m_FrameContext.IsViewCacheEnabled()) {
+            std::cout << "Target view cache: " << m_FrameContext.GetViewCacheHitCount() << " hits, "
+                      << m_FrameContext.GetViewCacheMissCount() << " misses\n";
+        }
+
+#ifdef WR_PROFILING
+        std::cout << "Profiler overhead: " << Profiler::MeasureScopeOverhead(1'000'000) << " ns per scope\n";
+#endif
+
+        if (reportPath.empty()) {
+            return success;
+        }
+
+        BenchmarkInfo info;
+        info.adapterName = m_AdapterName;
+        info.backendName = m_BackendName;
+        info.width = m_TargetWidth;
+        info.height = m_TargetHeight;
+        info.headless = m_Config.headless;
+        info.warmupFrameCount = m_Config.warmupFrameCount;
+        info.gpuTimestamps = m_GpuTimer.IsEnabled();
+        info.targetViewCache = m_FrameContext.IsViewCacheEnabled();
+        info.framesInFlight = m_FrameRing.GetFramesInFlight();
+        info.presentMode = m_Config.headless ? "offscreen"
+                                             : magic_enum::enum_name(static_cast<WGPUPresentMode>(m_PresentMode));
+        info.maxFrameRate = m_Config.maxFrameRate;
+        info.lowLatency = m_Config.lowLatency;
+        info.instanceCount = m_Instances.GetInstanceCount();
+        info.drawMode = magic_enum::enum_name(m_Config.drawMode);
+
+        if (!benchmark.WriteReport(reportPath, info)) {
+            std::cerr << "Couldn't write the benchmark report to " << reportPath << "!\n";
+            return false;
+        }
+
+        std::cout << "Wrote the benchmark report to " << reportPath << '\n';
+        return success;
+    }
+
+    double Application::GetElapsedMilliseconds(const std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    wgpu::Texture Application::GetNextSurfaceTexture() {
+        WR_PROFILE_SCOPE("Application::GetNextSurfaceTexture");
+
         wgpu::SurfaceTexture surfaceTexture;
         m_Surface.getCurrentTexture(&surfaceTexture);
 
-        if (surfaceTexture.status != wgpu::SurfaceGetCurrentTextureStatus::Success) {
-            return nullptr;
+        switch (surfaceTexture.status) {
+            case wgpu::SurfaceGetCurrentTextureStatus::Success:
+                // A suboptimal texture can still be rendered to, the surface is reconfigured for the next frame.
+                if (surfaceTexture.suboptimal) {
+                    m_SurfaceResizePending = true;
+                }
+
+                return surfaceTexture.texture;
+
+            case wgpu::SurfaceGetCurrentTextureStatus::Timeout:
+                // Skip the frame, the next one will try again.
+                return nullptr;
+
+            case wgpu::SurfaceGetCurrentTextureStatus::Outdated:
+            case wgpu::SurfaceGetCurrentTextureStatus::Lost:
+                // The window changed under the surface, e.g. it was resized before the resize event arrived.
+                m_SurfaceResizePending = true;
+                return nullptr;
+
+            default:
+                std::cerr << "Couldn't get the surface texture: status: " << surfaceTexture.status << '\n';
+                return nullptr;
         }
-        wgpu::Texture texture = surfaceTexture.texture;
+    }
 
-        wgpu::TextureViewDescriptor viewDescriptor;
-        viewDescriptor.nextInChain = nullptr;
+    bool Application::UpdateSurfaceSize() {
+        if (m_FramebufferWidth == 0 || m_FramebufferHeight == 0) {
+            return false;
+        }
+
+        if (m_SurfaceResizePending) {
+            ReconfigureSurface();
+        }
+
+        return true;
+    }
+
+    void Application::ReconfigureSurface() {
+        WR_PROFILE_SCOPE("Application::ReconfigureSurface");
+
+        m_SurfaceResizePending = false;
+
+        m_TargetWidth = m_FramebufferWidth;
+        m_TargetHeight = m_FramebufferHeight;
+        m_SurfaceConfiguration.width = m_TargetWidth;
+        m_SurfaceConfiguration.height = m_TargetHeight;
+        m_Surface.configure(m_SurfaceConfiguration);
+
+        UpdateViewUniforms();
+    }
+
+    void Application::UpdateViewUniforms() {
+        // writeBuffer is ordered with the submissions, the frames already submitted keep the previous ratio.
+        const std::array<float, 4> viewUniforms = {
+            static_cast<float>(m_TargetWidth) / static_cast<float>(m_TargetHeight), 0.0f, 0.0f, 0.0f,
+        };
+
+        m_Queue.writeBuffer(m_Resources.Get(m_ViewUniformBuffer), 0, viewUniforms.data(), sizeof(viewUniforms));
+    }
+
+    void Application::OnFramebufferResized(GLFWwindow* window, const int width, const int height) {
+        auto* application = static_cast<Application*>(glfwGetWindowUserPointer(window));
+        application->m_FramebufferWidth = static_cast<uint32_t>(width);
+        application->m_FramebufferHeight = static_cast<uint32_t>(height);
+        application->m_SurfaceResizePending = true;
+    }
+
+    wgpu::PresentMode Application::SelectPresentMode(wgpu::Adapter adapter) {
+        wgpu::SurfaceCapabilities capabilities{};
+        m_Surface.getCapabilities(adapter, &capabilities);
+
+        const std::span<const WGPUPresentMode> presentModes(capabilities.presentModes, capabilities.presentModeCount);
+        const auto requestedMode = static_cast<WGPUPresentMode>(m_Config.presentMode);
+        const bool supported = std::ranges::find(presentModes, requestedMode) != presentModes.end();
+
+        capabilities.freeMembers();
+
+        const auto requestedName = magic_enum::enum_name(requestedMode);
+        if (!supported) {
+            std::cout << "Present mode " << requestedName << " isn't supported by the surface, using Fifo\n";
+            return wgpu::PresentMode::Fifo;
+        }
+
+        std::cout << "Using present mode " << requestedName << '\n';
+        return m_Config.presentMode;
+    }
+
+    bool Application::InitializeOffscreenTarget() {
+        // An sRGB format like the surfaces usually prefer, so that the shader's gamma correction stays right. RGBA
+        // rather than BGRA so that the read back pixels can be written as is.
+        m_SurfaceFormat = wgpu::TextureFormat::RGBA8UnormSrgb;
+        m_TargetWidth = m_Config.width;
+        m_TargetHeight = m_Config.height;
+
+        wgpu::TextureDescriptor textureDesc{};
+        textureDesc.nextInChain = nullptr;
 #ifdef WR_DEBUG
-        viewDescriptor.label = "Surface texture view";
+        textureDesc.label = "Offscreen target";
 #else
-        viewDescriptor.label = nullptr;
+        textureDesc.label = nullptr;
 #endif
-        viewDescriptor.format = texture.getFormat();
-        viewDescriptor.dimension = wgpu::TextureViewDimension::_2D;
-        viewDescriptor.baseMipLevel = 0;
-        viewDescriptor.mipLevelCount = 1;
-        viewDescriptor.baseArrayLayer = 0;
-        viewDescriptor.arrayLayerCount = 1;
-        viewDescriptor.aspect = wgpu::TextureAspect::All;
-        const wgpu::TextureView targetView = texture.createView(viewDescriptor);
-
-        return targetView;
+        textureDesc.usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::CopySrc;
+        textureDesc.dimension = wgpu::TextureDimension::_2D;
+        textureDesc.size.width = m_TargetWidth;
+        textureDesc.size.height = m_TargetHeight;
+        textureDesc.size.depthOrArrayLayers = 1;
+        textureDesc.format = m_SurfaceFormat;
+        textureDesc.mipLevelCount = 1;
+        textureDesc.sampleCount = 1;
+        textureDesc.viewFormatCount = 0;
+        textureDesc.viewFormats = nullptr;
+        m_OffscreenTexture = m_Resources.Add(m_Device.createTexture(textureDesc));
+
+        if (!m_OffscreenTexture) {
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Application::SaveOffscreenTarget(const std::filesystem::path& path) {
+        constexpr uint32_t PixelSize = 4;
+        const uint32_t width = m_Config.width;
+        const uint32_t height = m_Config.height;
+
+        // Texture to buffer copies need rows aligned to 256 bytes.
+        const uint32_t rowSize = width * PixelSize;
+        const uint32_t paddedRowSize = (rowSize + 255) & ~255u;
+
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.size = static_cast<uint64_t>(paddedRowSize) * height;
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::MapRead;
+        bufferDesc.mappedAtCreation = false;
+        wgpu::Buffer readbackBuffer = m_Device.createBuffer(bufferDesc);
+
+        wgpu::CommandEncoderDescriptor encoderDesc;
+        encoderDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        encoderDesc.label = "Readback command encoder";
+#else
+        encoderDesc.label = nullptr;
+#endif
+        wgpu::CommandEncoder encoder = m_Device.createCommandEncoder(encoderDesc);
+
+        wgpu::ImageCopyTexture source{};
+        source.texture = m_Resources.Get(m_OffscreenTexture);
+        source.mipLevel = 0;
+        source.origin.x = 0;
+        source.origin.y = 0;
+        source.origin.z = 0;
+        source.aspect = wgpu::TextureAspect::All;
+
+        wgpu::ImageCopyBuffer destination{};
+        destination.buffer = readbackBuffer;
+        destination.layout.offset = 0;
+        destination.layout.bytesPerRow = paddedRowSize;
+        destination.layout.rowsPerImage = height;
+
+        wgpu::Extent3D copySize{};
+        copySize.width = width;
+        copySize.height = height;
+        copySize.depthOrArrayLayers = 1;
+
+        encoder.copyTextureToBuffer(source, destination, copySize);
+
+        wgpu::CommandBuffer cmdBuffer = encoder.finish(m_FrameContext.GetCommandBufferDescriptor());
+        encoder.release();
+
+        m_Queue.submit(1, &cmdBuffer);
+        cmdBuffer.release();
+
+        // Block until the copy is done, the readback happens once at the end of the run.
+        bool done = false;
+        bool mapped = false;
+        const auto mapCallbackHandle = readbackBuffer.mapAsync(wgpu::MapMode::Read, 0, bufferDesc.size,
+            [&done, &mapped](const wgpu::BufferMapAsyncStatus status) {
+                done = true;
+                mapped = status == wgpu::BufferMapAsyncStatus::Success;
+            });
+
+        while (!done) {
+            m_Device.poll(true);
+        }
+
+        bool saved = false;
+        if (mapped) {
+            const auto* data = static_cast<const uint8_t*>(readbackBuffer.getConstMappedRange(0, bufferDesc.size));
+
+            // Drop the row padding.
+            std::vector<uint8_t> pixels(static_cast<size_t>(rowSize) * height);
+            for (uint32_t y = 0; y < height; ++y) {
+                std::memcpy(pixels.data() + static_cast<size_t>(y) * rowSize,
+                            data + static_cast<size_t>(y) * paddedRowSize, rowSize);
+            }
+
+            readbackBuffer.unmap();
+            saved = ImageWriter::Write(path, width, height, pixels);
+        }
+
+        readbackBuffer.destroy();
+        readbackBuffer.release();
+
+        if (!saved) {
+            std::cerr << "Couldn't save the offscreen target to " << path << "!\n";
+            return false;
+        }
+
+        std::cout << "Saved the last frame to " << path << '\n';
+        return true;
     }
 }
@@ -0,0 +1,217 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/ApplicationConfig.hpp>
+#include <WGPURenderer/FrameRing.hpp>
+
+#include <array>
+#include <charconv>
+#include <iostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        bool ParseUnsigned(const std::string_view text, uint32_t& value) {
+            const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            return ec == std::errc{} && ptr == text.data() + text.size();
+        }
+
+        // Comma-separated positive values, e.g. 1000,10000.
+        bool ParseUnsignedList(std::string_view text, std::vector<uint32_t>& values) {
+            values.clear();
+            while (true) {
+                const size_t separator = text.find(',');
+                uint32_t value;
+                if (!ParseUnsigned(text.substr(0, separator), value) || value == 0) {
+                    return false;
+                }
+
+                values.push_back(value);
+                if (separator == std::string_view::npos) {
+                    return true;
+                }
+
+                text.remove_prefix(separator + 1);
+            }
+        }
+
+        // WIDTHxHEIGHT, e.g. 1920x1080.
+        bool ParseSize(const std::string_view text, uint32_t& width, uint32_t& height) {
+            const size_t separator = text.find('x');
+            return separator != std::string_view::npos && ParseUnsigned(text.substr(0, separator), width) &&
+                   ParseUnsigned(text.substr(separator + 1), height) && width > 0 && height > 0;
+        }
+
+        bool ParseDrawMode(const std::string_view text, DrawMode& drawMode) {
+            constexpr std::array<std::pair<std::string_view, DrawMode>, 3> DrawModes = {{
+                {"direct", DrawMode::Direct},
+                {"indirect", DrawMode::Indirect},
+                {"gpu-culling", DrawMode::GpuCulling},
+            }};
+
+            for (const auto& [name, mode] : DrawModes) {
+                if (text == name) {
+                    drawMode = mode;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool ParsePresentMode(const std::string_view text, wgpu::PresentMode& presentMode) {
+            constexpr std::array<std::pair<std::string_view, WGPUPresentMode>, 4> PresentModes = {{
+                {"fifo", wgpu::PresentMode::Fifo},
+                {"fifo-relaxed", wgpu::PresentMode::FifoRelaxed},
+                {"mailbox", wgpu::PresentMode::Mailbox},
+                {"immediate", wgpu::PresentMode::Immediate},
+            }};
+
+            for (const auto& [name, mode] : PresentModes) {
+                if (text == name) {
+                    presentMode = mode;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    }
+
+    uint32_t ApplicationConfig::GetFrameCount() const {
+        if (frameCount != 0) {
+            return frameCount;
+        }
+
+        if (benchmark) {
+            return DefaultBenchmarkFrameCount;
+        }
+
+        return headless ? 1 : 0;
+    }
+
+    bool ApplicationConfig::ParseCommandLine(const int argc, const char* const* argv, ApplicationConfig& config) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view argument = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+            bool valid = true;
+            if (argument == "--headless") {
+                config.headless = true;
+            } else if (argument == "--fallback-adapter") {
+                config.forceFallbackAdapter = true;
+            } else if (argument == "--no-view-cache") {
+                config.cacheTargetViews = false;
+            } else if (argument == "--benchmark") {
+                config.benchmark = true;
+            } else if (argument == "--warmup" && value) {
+                valid = ParseUnsigned(value, config.warmupFrameCount);
+                ++i;
+            } else if (argument == "--report" && value) {
+                config.reportPath = value;
+                ++i;
+            } else if (argument == "--require-no-alloc") {
+                config.requireNoAllocations = true;
+            } else if (argument == "--trace" && value) {
+                config.tracePath = value;
+                ++i;
+            } else if (argument == "--frames-in-flight" && value) {
+                valid = ParseUnsigned(value, config.framesInFlight) && config.framesInFlight > 0 &&
+                        config.framesInFlight <= FrameRing::MaxFramesInFlight;
+                ++i;
+            } else if (argument == "--present-mode" && value) {
+                valid = ParsePresentMode(value, config.presentMode);
+                ++i;
+            } else if (argument == "--max-fps" && value) {
+                valid = ParseUnsigned(value, config.maxFrameRate);
+                ++i;
+            } else if (argument == "--instances" && value) {
+                valid = ParseUnsigned(value, config.instanceCount) && config.instanceCount > 0;
+                ++i;
+            } else if (argument == "--instance-sweep" && value) {
+                valid = ParseUnsignedList(value, config.instanceSweep);
+                ++i;
+            } else if (argument == "--draw" && value) {
+                valid = ParseDrawMode(value, config.drawMode);
+                ++i;
+            } else if (argument == "--upload-budget" && value) {
+                valid = ParseUnsigned(value, config.uploadBudget);
+                ++i;
+            } else if (argument == "--low-latency") {
+                config.lowLatency = true;
+            } else if (argument == "--workers" && value) {
+                valid = ParseUnsigned(value, config.workerCount);
+                ++i;
+            } else if (argument == "--size" && value) {
+                valid = ParseSize(value, config.width, config.height);
+                ++i;
+            } else if (argument == "--frames" && value) {
+                valid = ParseUnsigned(value, config.frameCount) && config.frameCount > 0;
+                ++i;
+            } else if (argument == "--output" && value) {
+                config.outputPath = value;
+                ++i;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                if (argument != "--help") {
+                    std::cerr << "Invalid argument: " << argument << '\n';
+                }
+
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+
+        if (!config.outputPath.empty() && !config.headless) {
+            std::cerr << "--output requires --headless\n";
+            return false;
+        }
+
+        if (!config.reportPath.empty() && !config.benchmark) {
+            std::cerr << "--report requires --benchmark\n";
+            return false;
+        }
+
+        if (!config.instanceSweep.empty() && !config.benchmark) {
+            std::cerr << "--instance-sweep requires --benchmark\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    void ApplicationConfig::PrintUsage(const char* programName) {
+        std::cout << "Usage: " << programName << " [options]\n"
+                  << "  --size WIDTHxHEIGHT   Size of the window or of the offscreen target (default 640x480)\n"
+                  << "  --headless            Render offscreen, without a window\n"
+                  << "  --frames N            Number of frames to render, or to measure in benchmark mode\n"
+                  << "                        (default: until the window is closed, 1 headless, "
+                  << DefaultBenchmarkFrameCount << " in benchmark mode)\n"
+                  << "  --output PATH         Headless: write the last frame to a .ppm or .png image\n"
+                  << "  --benchmark           Measure the frame times and print their statistics\n"
+                  << "  --warmup N            Benchmark: frames rendered before measuring (default 60)\n"
+                  << "  --report PATH         Benchmark: write a JSON report of the run\n"
+                  << "  --require-no-alloc    Benchmark: fail if a measured frame allocates from the heap\n"
+                  << "  --fallback-adapter    Use a software adapter\n"
+                  << "  --no-view-cache       Headless: create the target view every frame instead of reusing it\n"
+                  << "  --frames-in-flight N  Frames recorded ahead of the GPU, up to "
+                  << FrameRing::MaxFramesInFlight << " (default 2)\n"
+                  << "  --instances N         Copies of the mesh to draw (default 1)\n"
+                  << "  --instance-sweep LIST Benchmark: measure each comma-separated instance count in turn,\n"
+                  << "                        e.g. 1000,10000,100000,1000000\n"
+                  << "  --draw MODE           direct, indirect or gpu-culling (default direct)\n"
+                  << "  --upload-budget KIB   Upload at most KIB KiB per frame (default 0, no limit)\n"
+                  << "  --present-mode MODE   fifo, fifo-relaxed, mailbox or immediate (default fifo)\n"
+                  << "  --max-fps N           Limit the frame rate on the CPU (default 0, unlimited)\n"
+                  << "  --low-latency         Wait for the previous frame before polling the input\n"
+                  << "  --workers N           Worker threads of the job system (default 0, one per core)\n"
+                  << "  --trace PATH          Profiling builds: write the Chrome trace there (default trace.json)\n"
+                  << "  --help                Print this message\n";
+    }
+}
@@ -0,0 +1,236 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/Benchmark.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string_view>
+
+namespace WGPURenderer {
+    namespace {
+        struct Metric {
+            std::string_view name;
+            double FrameTimings::* member;
+        };
+
+        constexpr std::array<Metric, 7> Metrics = {{
+            {"frame", &FrameTimings::frame},
+            {"pacing", &FrameTimings::pacing},
+            {"wait", &FrameTimings::wait},
+            {"acquire", &FrameTimings::acquire},
+            {"encode", &FrameTimings::encode},
+            {"submit", &FrameTimings::submit},
+            {"present", &FrameTimings::present},
+        }};
+
+        double GetNearestRank(const std::span<const double> sortedSamples, const double percentile) {
+            const double count = static_cast<double>(sortedSamples.size());
+            const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * count));
+            return sortedSamples[std::clamp<size_t>(rank, 1, sortedSamples.size()) - 1];
+        }
+
+        std::string EscapeJson(const std::string_view text) {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (const char c : text) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                    escaped += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    constexpr std::string_view digits = "0123456789abcdef";
+                    escaped += "\\u00";
+                    escaped += digits[(c >> 4) & 0xF];
+                    escaped += digits[c & 0xF];
+                } else {
+                    escaped += c;
+                }
+            }
+
+            return escaped;
+        }
+    }
+
+    Benchmark::Benchmark(const size_t expectedFrameCount) {
+        // Reserved upfront, so that recording the frames doesn't allocate while they are measured.
+        m_Frames.reserve(expectedFrameCount);
+        m_GpuFrameTimes.reserve(expectedFrameCount);
+    }
+
+    void Benchmark::AddFrame(const FrameTimings& timings) {
+        m_Frames.push_back(timings);
+    }
+
+    void Benchmark::AddGpuFrame(const double duration) {
+        m_GpuFrameTimes.push_back(duration);
+    }
+
+    void Benchmark::SetTotalTime(const double totalTime) {
+        m_TotalTime = totalTime;
+    }
+
+    size_t Benchmark::GetFrameCount() const {
+        return m_Frames.size();
+    }
+
+    uint32_t Benchmark::GetMaxHeapAllocationCount() const {
+        uint32_t maxCount = 0;
+        for (const FrameTimings& timings : m_Frames) {
+            maxCount = std::max(maxCount, timings.heapAllocationCount);
+        }
+
+        return maxCount;
+    }
+
+    void Benchmark::PrintSummary() const {
+        const std::ios::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+
+        std::cout << std::fixed << std::setprecision(3) << "Benchmark: " << m_Frames.size() << " frames in "
+                  << m_TotalTime << " ms (" << GetAverageFps() << " FPS)\n"
+                  << "  CPU time (ms)      min   median      p95      p99      max\n";
+
+        const auto printRow = [](const std::string_view name, const TimingStatistics& statistics) {
+            std::cout << "  " << std::left << std::setw(10) << name << std::right << std::setw(11)
+                      << statistics.min << std::setw(9) << statistics.median << std::setw(9) << statistics.p95
+                      << std::setw(9) << statistics.p99 << std::setw(9) << statistics.max << '\n';
+        };
+
+        for (const Metric& metric : Metrics) {
+            printRow(metric.name, ComputeStatistics(metric.member));
+        }
+
+        const TimingStatistics inFlight = ComputeStatistics(&FrameTimings::inFlightCount);
+        const TimingStatistics heapAllocations = ComputeStatistics(&FrameTimings::heapAllocationCount);
+        std::cout << std::setprecision(2) << "  Frames in flight: mean " << inFlight.mean << ", max "
+                  << static_cast<uint32_t>(inFlight.max) << '\n'
+                  << "  Heap allocations per frame: mean " << heapAllocations.mean << ", max "
+                  << static_cast<uint32_t>(heapAllocations.max) << '\n' << std::setprecision(3);
+
+        if (m_GpuFrameTimes.empty()) {
+            std::cout << "  No GPU timings\n";
+        } else {
+            std::cout << "  GPU time (ms), " << m_GpuFrameTimes.size() << " frames\n";
+            printRow("passes", ComputeStatistics(m_GpuFrameTimes));
+        }
+
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+    }
+
+    bool Benchmark::WriteReport(const std::filesystem::path& path, const BenchmarkInfo& info) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        file << std::setprecision(6) << std::boolalpha;
+        file << "{\n"
+             << "  \"adapter\": \"" << EscapeJson(info.adapterName) << "\",\n"
+             << "  \"backend\": \"" << EscapeJson(info.backendName) << "\",\n"
+             << "  \"width\": " << info.width << ",\n"
+             << "  \"height\": " << info.height << ",\n"
+             << "  \"headless\": " << info.headless << ",\n"
+             << "  \"gpuTimestamps\": " << info.gpuTimestamps << ",\n"
+             << "  \"targetViewCache\": " << info.targetViewCache << ",\n"
+             << "  \"framesInFlight\": " << info.framesInFlight << ",\n"
+             << "  \"presentMode\": \"" << EscapeJson(info.presentMode) << "\",\n"
+             << "  \"maxFrameRate\": " << info.maxFrameRate << ",\n"
+             << "  \"lowLatency\": " << info.lowLatency << ",\n"
+             << "  \"instances\": " << info.instanceCount << ",\n"
+             << "  \"drawMode\": \"" << EscapeJson(info.drawMode) << "\",\n"
+             << "  \"warmupFrames\": " << info.warmupFrameCount << ",\n"
+             << "  \"measuredFrames\": " << m_Frames.size() << ",\n"
+             << "  \"totalTimeMs\": " << m_TotalTime << ",\n"
+             << "  \"averageFps\": " << GetAverageFps() << ",\n"
+             << "  \"cpuTimeMs\": {\n";
+
+        const auto writeStatistics = [&file](const TimingStatistics& statistics) {
+            file << "{"
+                 << "\"min\": " << statistics.min << ", "
+                 << "\"mean\": " << statistics.mean << ", "
+                 << "\"median\": " << statistics.median << ", "
+                 << "\"p95\": " << statistics.p95 << ", "
+                 << "\"p99\": " << statistics.p99 << ", "
+                 << "\"max\": " << statistics.max << '}';
+        };
+
+        for (size_t i = 0; i < Metrics.size(); ++i) {
+            file << "    \"" << Metrics[i].name << "\": ";
+            writeStatistics(ComputeStatistics(Metrics[i].member));
+            file << (i + 1 < Metrics.size() ? ",\n" : "\n");
+        }
+
+        file << "  },\n"
+             << "  \"inFlightCount\": ";
+        writeStatistics(ComputeStatistics(&FrameTimings::inFlightCount));
+
+        file << ",\n"
+             << "  \"heapAllocations\": ";
+        writeStatistics(ComputeStatistics(&FrameTimings::heapAllocationCount));
+
+        file << ",\n"
+             << "  \"gpuFrames\": " << m_GpuFrameTimes.size() << ",\n"
+             << "  \"gpuTimeMs\": ";
+
+        if (m_GpuFrameTimes.empty()) {
+            file << "null";
+        } else {
+            writeStatistics(ComputeStatistics(m_GpuFrameTimes));
+        }
+
+        file << "\n"
+             << "}\n";
+
+        file.close();
+        return !file.fail();
+    }
+
+    TimingStatistics Benchmark::ComputeStatistics(const std::span<const double> samples) {
+        TimingStatistics statistics;
+        if (samples.empty()) {
+            return statistics;
+        }
+
+        std::vector<double> sorted(samples.begin(), samples.end());
+        std::ranges::sort(sorted);
+
+        const size_t middle = sorted.size() / 2;
+        statistics.min = sorted.front();
+        statistics.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+        statistics.median = sorted.size() % 2 != 0 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.0;
+        statistics.p95 = GetNearestRank(sorted, 95.0);
+        statistics.p99 = GetNearestRank(sorted, 99.0);
+        statistics.max = sorted.back();
+
+        return statistics;
+    }
+
+    double Benchmark::GetAverageFps() const {
+        return m_TotalTime > 0.0 ? static_cast<double>(m_Frames.size()) * 1000.0 / m_TotalTime : 0.0;
+    }
+
+    TimingStatistics Benchmark::ComputeStatistics(double FrameTimings::* metric) const {
+        std::vector<double> samples(m_Frames.size());
+        std::ranges::transform(m_Frames, samples.begin(), [metric](const FrameTimings& timings) {
+            return timings.*metric;
+        });
+
+        return ComputeStatistics(samples);
+    }
+
+    TimingStatistics Benchmark::ComputeStatistics(uint32_t FrameTimings::* count) const {
+        std::vector<double> samples(m_Frames.size());
+        std::ranges::transform(m_Frames, samples.begin(), [count](const FrameTimings& timings) {
+            return static_cast<double>(timings.*count);
+        });
+
+        return ComputeStatistics(samples);
+    }
+}
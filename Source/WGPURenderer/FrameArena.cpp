@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/FrameArena.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace WGPURenderer {
+    FrameArena::FrameArena(const size_t blockSize)
+        : m_BlockSize(blockSize) {
+    }
+
+    void FrameArena::Reset() {
+        if (m_Blocks.size() > 1) {
+            size_t totalSize = 0;
+            for (const Block& block : m_Blocks) {
+                totalSize += block.size;
+            }
+
+            m_Blocks.clear();
+            AddBlock(totalSize);
+        }
+
+        m_CurrentBlock = 0;
+        m_Offset = 0;
+        m_UsedBeforeCurrentBlock = 0;
+        m_AllocationCount = 0;
+    }
+
+    uint64_t FrameArena::GetAllocationCount() const {
+        return m_AllocationCount;
+    }
+
+    size_t FrameArena::GetUsedSize() const {
+        return m_UsedBeforeCurrentBlock + m_Offset;
+    }
+
+    size_t FrameArena::GetPeakUsedSize() const {
+        return m_PeakUsedSize;
+    }
+
+    size_t FrameArena::GetCapacity() const {
+        size_t capacity = 0;
+        for (const Block& block : m_Blocks) {
+            capacity += block.size;
+        }
+
+        return capacity;
+    }
+
+    uint64_t FrameArena::GetBlockAllocationCount() const {
+        return m_BlockAllocationCount;
+    }
+
+    FrameArena& FrameArena::GetThreadArena() {
+        thread_local FrameArena arena;
+        return arena;
+    }
+
+    void* FrameArena::do_allocate(const size_t bytes, const size_t alignment) {
+        // The blocks too small for the allocation are skipped for the rest of the frame.
+        while (m_CurrentBlock < m_Blocks.size()) {
+            if (void* pointer = AllocateFromCurrentBlock(bytes, alignment)) {
+                return pointer;
+            }
+
+            m_UsedBeforeCurrentBlock += m_Blocks[m_CurrentBlock].size;
+            ++m_CurrentBlock;
+            m_Offset = 0;
+        }
+
+        AddBlock(std::max(m_BlockSize, bytes + alignment));
+        return AllocateFromCurrentBlock(bytes, alignment);
+    }
+
+    void FrameArena::do_deallocate(void* /*pointer*/, size_t /*bytes*/, size_t /*alignment*/) {
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    void FrameArena::AddBlock(const size_t size) {
+        Block block;
+        block.data = std::make_unique_for_overwrite<std::byte[]>(size);
+        block.size = size;
+        m_Blocks.push_back(std::move(block));
+        ++m_BlockAllocationCount;
+    }
+
+    void* FrameArena::AllocateFromCurrentBlock(const size_t bytes, const size_t alignment) {
+        const Block& block = m_Blocks[m_CurrentBlock];
+        const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        const size_t offset = (base + m_Offset + alignment - 1) / alignment * alignment - base;
+        if (offset + bytes > block.size) {
+            return nullptr;
+        }
+
+        m_Offset = offset + bytes;
+        ++m_AllocationCount;
+        m_PeakUsedSize = std::max(m_PeakUsedSize, GetUsedSize());
+
+        return block.data.get() + offset;
+    }
+}
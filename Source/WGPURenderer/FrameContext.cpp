@@ -0,0 +1,132 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/FrameContext.hpp>
+
+namespace WGPURenderer {
+    FrameContext::FrameContext() {
+        m_EncoderDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        m_EncoderDesc.label = "Main command encoder";
+#else
+        m_EncoderDesc.label = nullptr;
+#endif
+
+        m_ColorAttachment.nextInChain = nullptr;
+        m_ColorAttachment.view = nullptr;
+        m_ColorAttachment.resolveTarget = nullptr;
+        m_ColorAttachment.loadOp = wgpu::LoadOp::Clear;
+        m_ColorAttachment.storeOp = wgpu::StoreOp::Store;
+        m_ColorAttachment.clearValue = wgpu::Color{0.01, 0.01, 0.01, 1.0};
+
+        m_RenderPassDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        m_RenderPassDesc.label = "Main render pass";
+#else
+        m_RenderPassDesc.label = nullptr;
+#endif
+        m_RenderPassDesc.colorAttachmentCount = 1;
+        m_RenderPassDesc.colorAttachments = &m_ColorAttachment;
+        m_RenderPassDesc.depthStencilAttachment = nullptr;
+        m_RenderPassDesc.timestampWrites = nullptr;
+
+        m_CommandBufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        m_CommandBufferDesc.label = "Main command buffer";
+#else
+        m_CommandBufferDesc.label = nullptr;
+#endif
+
+        m_ViewDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        m_ViewDesc.label = "Render target view";
+#else
+        m_ViewDesc.label = nullptr;
+#endif
+        m_ViewDesc.format = wgpu::TextureFormat::Undefined;
+        m_ViewDesc.dimension = wgpu::TextureViewDimension::_2D;
+        m_ViewDesc.baseMipLevel = 0;
+        m_ViewDesc.mipLevelCount = 1;
+        m_ViewDesc.baseArrayLayer = 0;
+        m_ViewDesc.arrayLayerCount = 1;
+        m_ViewDesc.aspect = wgpu::TextureAspect::All;
+    }
+
+    void FrameContext::Initialize(const wgpu::TextureFormat targetFormat, const bool cacheViews) {
+        Reset();
+        m_ViewDesc.format = targetFormat;
+        m_CacheViews = cacheViews;
+    }
+
+    void FrameContext::Reset() {
+        if (m_CachedView) {
+            m_CachedView.release();
+            m_CachedTexture.release();
+        }
+
+        m_CachedView = nullptr;
+        m_CachedTexture = nullptr;
+    }
+
+    wgpu::TextureView FrameContext::AcquireTargetView(wgpu::Texture texture) {
+        if (!m_CacheViews) {
+            return texture.createView(m_ViewDesc);
+        }
+
+        if (m_CachedView && texture == m_CachedTexture) {
+            ++m_HitCount;
+            return m_CachedView;
+        }
+
+        ++m_MissCount;
+
+        wgpu::TextureView view = texture.createView(m_ViewDesc);
+        if (!view) {
+            return nullptr;
+        }
+
+        Reset();
+
+        texture.reference();
+        m_CachedTexture = texture;
+        m_CachedView = view;
+
+        return view;
+    }
+
+    void FrameContext::ReleaseTargetView(wgpu::TextureView view) {
+        // The cached view stays alive until another texture is acquired or the context is reset.
+        if (!m_CacheViews) {
+            view.release();
+        }
+    }
+
+    const wgpu::CommandEncoderDescriptor& FrameContext::GetEncoderDescriptor() const {
+        return m_EncoderDesc;
+    }
+
+    const wgpu::RenderPassDescriptor& FrameContext::GetRenderPassDescriptor(
+        const wgpu::TextureView targetView, const wgpu::RenderPassTimestampWrites* timestampWrites) {
+        m_ColorAttachment.view = targetView;
+        m_RenderPassDesc.timestampWrites = timestampWrites;
+
+        return m_RenderPassDesc;
+    }
+
+    const wgpu::CommandBufferDescriptor& FrameContext::GetCommandBufferDescriptor() const {
+        return m_CommandBufferDesc;
+    }
+
+    bool FrameContext::IsViewCacheEnabled() const {
+        return m_CacheViews;
+    }
+
+    uint64_t FrameContext::GetViewCacheHitCount() const {
+        return m_HitCount;
+    }
+
+    uint64_t FrameContext::GetViewCacheMissCount() const {
+        return m_MissCount;
+    }
+}
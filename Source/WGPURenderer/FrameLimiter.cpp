@@ -0,0 +1,45 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/FrameLimiter.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <thread>
+
+namespace WGPURenderer {
+    FrameLimiter::FrameLimiter(const double maxFrameRate) {
+        if (maxFrameRate > 0.0) {
+            const std::chrono::duration<double> framePeriod(1.0 / maxFrameRate);
+            m_FramePeriod = std::chrono::duration_cast<Clock::duration>(framePeriod);
+        }
+    }
+
+    void FrameLimiter::Wait() {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        WR_PROFILE_SCOPE("FrameLimiter::Wait");
+
+        const Clock::time_point now = Clock::now();
+        if (now >= m_NextFrameStart) {
+            m_NextFrameStart = now + m_FramePeriod;
+            return;
+        }
+
+        if (m_NextFrameStart - now > SpinDuration) {
+            std::this_thread::sleep_until(m_NextFrameStart - SpinDuration);
+        }
+
+        while (Clock::now() < m_NextFrameStart) {
+            std::this_thread::yield();
+        }
+
+        m_NextFrameStart += m_FramePeriod;
+    }
+
+    bool FrameLimiter::IsEnabled() const {
+        return m_FramePeriod != Clock::duration::zero();
+    }
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/FrameRing.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <algorithm>
+
+namespace WGPURenderer {
+    void FrameRing::Initialize(wgpu::Device device, wgpu::Queue queue, const uint32_t framesInFlight) {
+        m_Device = device;
+        m_Queue = queue;
+        m_FramesInFlight = std::clamp<uint32_t>(framesInFlight, 1, MaxFramesInFlight);
+        m_CurrentSlot = 0;
+    }
+
+    void FrameRing::Terminate() {
+        // The callbacks must outlive the submissions they track, so they are kept until the GPU is done.
+        WaitForAll();
+    }
+
+    uint32_t FrameRing::BeginFrame() {
+        WR_PROFILE_SCOPE("FrameRing::BeginFrame");
+
+        Slot& slot = m_Slots[m_CurrentSlot];
+        if (slot.inFlight) {
+            // Processing the callbacks of the frames that completed since the last poll may be enough.
+            m_Device.poll(false);
+        }
+
+        WaitForSlot(slot);
+
+        return m_CurrentSlot;
+    }
+
+    void FrameRing::EndFrame(const wgpu::SubmissionIndex submissionIndex) {
+        Slot& slot = m_Slots[m_CurrentSlot];
+        slot.inFlight = true;
+        slot.submissionIndex = submissionIndex;
+        // The callback covers all the work submitted so far, so registering it right after the submission tracks
+        // this frame. The C entry point takes the slot as is, where the wrapper would allocate a std::function
+        // every frame.
+        wgpuQueueOnSubmittedWorkDone(m_Queue, &FrameRing::OnWorkDone, &slot);
+
+        m_CurrentSlot = (m_CurrentSlot + 1) % m_FramesInFlight;
+    }
+
+    void FrameRing::WaitForAll() {
+        for (Slot& slot : m_Slots) {
+            WaitForSlot(slot);
+        }
+    }
+
+    uint32_t FrameRing::GetFramesInFlight() const {
+        return m_FramesInFlight;
+    }
+
+    uint32_t FrameRing::GetInFlightCount() const {
+        return static_cast<uint32_t>(std::ranges::count(m_Slots, true, &Slot::inFlight));
+    }
+
+    void FrameRing::OnWorkDone(WGPUQueueWorkDoneStatus /*status*/, void* userdata) {
+        // Any failure, device loss included, ends the frame too so that waiting never hangs.
+        static_cast<Slot*>(userdata)->inFlight = false;
+    }
+
+    void FrameRing::WaitForSlot(Slot& slot) {
+        WR_PROFILE_SCOPE("FrameRing::WaitForSlot");
+
+        // Only waits for the slot's submission, not for the frames submitted after it.
+        wgpu::WrappedSubmissionIndex wrappedSubmissionIndex{};
+        wrappedSubmissionIndex.queue = m_Queue;
+        wrappedSubmissionIndex.submissionIndex = slot.submissionIndex;
+
+        while (slot.inFlight) {
+            m_Device.poll(true, wrappedSubmissionIndex);
+        }
+    }
+}
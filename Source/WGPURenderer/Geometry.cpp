@@ -0,0 +1,120 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/Geometry.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace WGPURenderer {
+    void Geometry::SetVertices(std::vector<std::byte>&& vertexData, const VertexLayout& layout,
+                               const VertexEncoding encoding) {
+        m_VertexStorage = std::move(vertexData);
+        m_VertexData = m_VertexStorage;
+        m_VertexLayout = layout;
+        m_VertexEncoding = encoding;
+    }
+
+    void Geometry::SetIndices(std::vector<uint32_t>&& indexData) {
+        const size_t indexCount = indexData.size();
+        const bool fitsShortIndices = std::ranges::all_of(indexData, [](const uint32_t index) {
+            return index <= std::numeric_limits<uint16_t>::max();
+        });
+
+        if (fitsShortIndices) {
+            // Padded to an even count, so that the upload size is a multiple of 4 bytes.
+            m_ShortIndexStorage.resize(indexCount + indexCount % 2, 0);
+            std::ranges::transform(indexData, m_ShortIndexStorage.begin(), [](const uint32_t index) {
+                return static_cast<uint16_t>(index);
+            });
+
+            m_IndexStorage.clear();
+            m_IndexData = std::as_bytes(std::span<const uint16_t>(m_ShortIndexStorage).first(indexCount));
+            m_IndexFormat = wgpu::IndexFormat::Uint16;
+        } else {
+            m_IndexStorage = std::move(indexData);
+
+            m_ShortIndexStorage.clear();
+            m_IndexData = std::as_bytes(std::span<const uint32_t>(m_IndexStorage));
+            m_IndexFormat = wgpu::IndexFormat::Uint32;
+        }
+    }
+
+    void Geometry::SetStorage(MappedFile&& storage) {
+        m_Storage = std::move(storage);
+    }
+
+    void Geometry::SetVertices(const std::span<const std::byte> vertexData, const VertexLayout& layout,
+                               const VertexEncoding encoding) {
+        m_VertexStorage.clear();
+        m_VertexData = vertexData;
+        m_VertexLayout = layout;
+        m_VertexEncoding = encoding;
+    }
+
+    void Geometry::SetIndices(const std::span<const std::byte> indexData, const wgpu::IndexFormat indexFormat) {
+        m_ShortIndexStorage.clear();
+        m_IndexStorage.clear();
+        m_IndexData = indexData;
+        m_IndexFormat = indexFormat;
+    }
+
+    void Geometry::SetPositionTransform(const PositionTransform& transform) {
+        m_PositionTransform = transform;
+    }
+
+    std::span<const std::byte> Geometry::GetVertexData() const {
+        return m_VertexData;
+    }
+
+    const VertexLayout& Geometry::GetVertexLayout() const {
+        return m_VertexLayout;
+    }
+
+    VertexEncoding Geometry::GetVertexEncoding() const {
+        return m_VertexEncoding;
+    }
+
+    size_t Geometry::GetVertexStride() const {
+        return m_VertexLayout.GetStride(m_VertexEncoding);
+    }
+
+    size_t Geometry::GetVertexCount() const {
+        const size_t stride = GetVertexStride();
+        return stride != 0 ? m_VertexData.size() / stride : 0;
+    }
+
+    const PositionTransform& Geometry::GetPositionTransform() const {
+        return m_PositionTransform;
+    }
+
+    std::span<const std::byte> Geometry::GetIndexData() const {
+        return m_IndexData;
+    }
+
+    wgpu::IndexFormat Geometry::GetIndexFormat() const {
+        return m_IndexFormat;
+    }
+
+    size_t Geometry::GetIndexCount() const {
+        const size_t indexSize = GetIndexSize(m_IndexFormat);
+        return indexSize != 0 ? m_IndexData.size() / indexSize : 0;
+    }
+
+    size_t Geometry::GetIndexUploadSize() const {
+        return (m_IndexData.size() + 3) & ~size_t{3};
+    }
+
+    size_t Geometry::GetIndexSize(const wgpu::IndexFormat indexFormat) {
+        switch (indexFormat) {
+            case wgpu::IndexFormat::Uint16:
+                return sizeof(uint16_t);
+            case wgpu::IndexFormat::Uint32:
+                return sizeof(uint32_t);
+            default:
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,281 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/GeometryCache.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr std::array<char, 4> CacheMagic = {'W', 'R', 'G', 'C'};
+        // Bump whenever the layout of the header or of the blobs changes.
+        constexpr uint32_t CacheVersion = 6;
+        constexpr uint64_t BlobAlignment = 64;
+
+        // The cache is a local artifact, so it is written with the native endianness.
+        struct CacheHeader {
+            std::array<char, 4> magic;
+            uint32_t version;
+            uint64_t sourceSize;
+            int64_t sourceWriteTime;
+            uint64_t sourceHash;
+            std::array<VertexLayoutAttribute, VertexLayout::MaxAttributeCount> vertexAttributes;
+            uint32_t vertexAttributeCount;
+            uint32_t vertexStride;
+            VertexEncoding vertexEncoding;
+            std::array<float, 3> positionScale;
+            std::array<float, 3> positionOffset;
+            uint64_t vertexCount;
+            uint64_t vertexOffset;
+            uint32_t indexSize;
+            uint32_t reserved;
+            uint64_t indexCount;
+            uint64_t indexOffset;
+        };
+
+        static_assert(std::is_trivially_copyable_v<CacheHeader>);
+
+        uint64_t HashContent(const std::string_view content) {
+            uint64_t hash = 0xcbf29ce484222325ull ^ content.size();
+            const auto mix = [&hash](const uint64_t word) {
+                hash = std::rotl(hash ^ (word * 0x87c37b91114253d5ull), 31) * 0x4cf5ad432745937full;
+            };
+
+            size_t offset = 0;
+            for (; offset + sizeof(uint64_t) <= content.size(); offset += sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, content.data() + offset, sizeof(word));
+                mix(word);
+            }
+
+            if (offset < content.size()) {
+                uint64_t word = 0;
+                std::memcpy(&word, content.data() + offset, content.size() - offset);
+                mix(word);
+            }
+
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+
+            return hash;
+        }
+
+        // Going through AddAttribute also validates the attributes read from the file.
+        bool ReadLayout(const CacheHeader& header, VertexLayout& layout) {
+            if (header.vertexAttributeCount == 0 || header.vertexAttributeCount > header.vertexAttributes.size()) {
+                return false;
+            }
+
+            layout = VertexLayout{};
+            for (uint32_t i = 0; i < header.vertexAttributeCount; ++i) {
+                const VertexLayoutAttribute& attribute = header.vertexAttributes[i];
+                if (!layout.AddAttribute(attribute.semantic, attribute.componentCount)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        bool IsInside(const uint64_t offset, const uint64_t size, const uint64_t fileSize) {
+            return offset <= fileSize && size <= fileSize - offset;
+        }
+
+        // Updates the stamp of a cache whose source was touched without being changed.
+        bool WriteSourceWriteTime(const std::filesystem::path& cachePath, const int64_t writeTime) {
+            std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            file.seekp(offsetof(CacheHeader, sourceWriteTime));
+            file.write(reinterpret_cast<const char*>(&writeTime), sizeof(writeTime));
+            file.close();
+            return !file.fail();
+        }
+
+        void WritePadding(std::ofstream& file, const uint64_t targetOffset) {
+            static constexpr std::array<char, BlobAlignment> zeros{};
+            const auto offset = static_cast<uint64_t>(file.tellp());
+            if (targetOffset > offset) {
+                file.write(zeros.data(), static_cast<std::streamsize>(targetOffset - offset));
+            }
+        }
+    }
+
+    std::filesystem::path GeometryCache::GetCachePath(const std::filesystem::path& sourcePath) {
+        std::filesystem::path cachePath = sourcePath;
+        cachePath += ".wrmesh";
+        return cachePath;
+    }
+
+    bool GeometryCache::GetSourceStamp(const std::filesystem::path& sourcePath, SourceStamp& stamp) {
+        std::error_code error;
+        stamp.size = std::filesystem::file_size(sourcePath, error);
+        if (error) {
+            return false;
+        }
+
+        stamp.writeTime = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+        return !error;
+    }
+
+    bool GeometryCache::Load(const std::filesystem::path& sourcePath, const VertexEncoding vertexEncoding,
+                             Geometry& geometry) {
+        WR_PROFILE_SCOPE("GeometryCache::Load");
+
+        const std::filesystem::path cachePath = GetCachePath(sourcePath);
+        MappedFile file;
+        if (!file.Open(cachePath)) {
+            return false;
+        }
+
+        std::span<const std::byte> data = file.GetData();
+        if (data.size() < sizeof(CacheHeader)) {
+            return false;
+        }
+
+        CacheHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        VertexLayout layout;
+        if (header.magic != CacheMagic || header.version != CacheVersion ||
+            header.vertexEncoding != vertexEncoding || !ReadLayout(header, layout) ||
+            header.vertexStride != layout.GetStride(vertexEncoding) ||
+            (header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t))) {
+            return false;
+        }
+
+        if (header.vertexOffset % BlobAlignment != 0 || header.indexOffset % BlobAlignment != 0 ||
+            header.vertexCount > data.size() / header.vertexStride ||
+            header.indexCount > data.size() / header.indexSize ||
+            !IsInside(header.vertexOffset, header.vertexCount * header.vertexStride, data.size()) ||
+            !IsInside(header.indexOffset, AlignUp(header.indexCount * header.indexSize, 4), data.size())) {
+            return false;
+        }
+
+        SourceStamp stamp;
+        if (!GetSourceStamp(sourcePath, stamp) || stamp.size != header.sourceSize) {
+            return false;
+        }
+
+        if (stamp.writeTime != header.sourceWriteTime) {
+            // The source was touched, only its content can tell whether the cache is still valid.
+            MappedFile source;
+            if (!source.Open(sourcePath)) {
+                return false;
+            }
+
+            const std::span<const std::byte> sourceData = source.GetData();
+            const std::string_view content(reinterpret_cast<const char*>(sourceData.data()), sourceData.size());
+            if (HashContent(content) != header.sourceHash) {
+                return false;
+            }
+
+            // The refreshed stamp spares hashing the source on the next loads, a cache that can't be written is
+            // still valid though. Files can't be written while mapped on every platform, so it is mapped again.
+            file.Close();
+            if (WriteSourceWriteTime(cachePath, stamp.writeTime)) {
+                header.sourceWriteTime = stamp.writeTime;
+            }
+
+            // The cache may have been replaced in the meantime, it must still be the one that was validated.
+            if (!file.Open(cachePath) || file.GetData().size() != data.size() ||
+                std::memcmp(file.GetData().data(), &header, sizeof(header)) != 0) {
+                return false;
+            }
+
+            data = file.GetData();
+        }
+
+        const wgpu::IndexFormat indexFormat = header.indexSize == sizeof(uint16_t) ? wgpu::IndexFormat::Uint16
+                                                                                   : wgpu::IndexFormat::Uint32;
+
+        geometry.SetVertices(data.subspan(header.vertexOffset, header.vertexCount * header.vertexStride),
+                             layout, header.vertexEncoding);
+        geometry.SetIndices(data.subspan(header.indexOffset, header.indexCount * header.indexSize), indexFormat);
+        geometry.SetPositionTransform({header.positionScale, header.positionOffset});
+        geometry.SetStorage(std::move(file));
+
+        return true;
+    }
+
+    bool GeometryCache::Store(const std::filesystem::path& sourcePath, const SourceStamp& sourceStamp,
+                              const std::string_view sourceContent, const Geometry& geometry) {
+        WR_PROFILE_SCOPE("GeometryCache::Store");
+
+        const std::span<const std::byte> vertexData = geometry.GetVertexData();
+        const std::span<const std::byte> indexData = geometry.GetIndexData();
+
+        CacheHeader header{};
+        header.magic = CacheMagic;
+        header.version = CacheVersion;
+        header.sourceSize = sourceStamp.size;
+        header.sourceWriteTime = sourceStamp.writeTime;
+        header.sourceHash = HashContent(sourceContent);
+        const std::span<const VertexLayoutAttribute> attributes = geometry.GetVertexLayout().GetAttributes();
+        std::ranges::copy(attributes, header.vertexAttributes.begin());
+        header.vertexAttributeCount = static_cast<uint32_t>(attributes.size());
+        header.vertexStride = static_cast<uint32_t>(geometry.GetVertexStride());
+        header.vertexEncoding = geometry.GetVertexEncoding();
+        header.positionScale = geometry.GetPositionTransform().scale;
+        header.positionOffset = geometry.GetPositionTransform().offset;
+        header.vertexCount = geometry.GetVertexCount();
+        header.vertexOffset = AlignUp(sizeof(CacheHeader), BlobAlignment);
+        header.indexSize = static_cast<uint32_t>(Geometry::GetIndexSize(geometry.GetIndexFormat()));
+        header.indexCount = geometry.GetIndexCount();
+        header.indexOffset = AlignUp(header.vertexOffset + vertexData.size_bytes(), BlobAlignment);
+
+        // Write to a temporary file first, so that an interrupted write never leaves a truncated cache behind.
+        const std::filesystem::path cachePath = GetCachePath(sourcePath);
+        std::filesystem::path temporaryPath = cachePath;
+        temporaryPath += ".tmp";
+
+        bool written;
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            WritePadding(file, header.vertexOffset);
+            file.write(reinterpret_cast<const char*>(vertexData.data()),
+                       static_cast<std::streamsize>(vertexData.size_bytes()));
+            WritePadding(file, header.indexOffset);
+            file.write(reinterpret_cast<const char*>(indexData.data()),
+                       static_cast<std::streamsize>(indexData.size_bytes()));
+            WritePadding(file, AlignUp(header.indexOffset + indexData.size_bytes(), 4));
+
+            file.close();
+            written = !file.fail();
+        }
+
+        std::error_code error;
+        if (!written) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        std::filesystem::rename(temporaryPath, cachePath, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,184 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/GpuTimer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace WGPURenderer {
+    bool GpuTimer::Initialize(wgpu::Device device) {
+        wgpu::QuerySetDescriptor querySetDesc{};
+        querySetDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        querySetDesc.label = "GPU timer query set";
+#else
+        querySetDesc.label = nullptr;
+#endif
+        querySetDesc.type = wgpu::QueryType::Timestamp;
+        querySetDesc.count = SlotCount * QueriesPerSlot;
+        m_QuerySet = device.createQuerySet(querySetDesc);
+
+        if (!m_QuerySet) {
+            return false;
+        }
+
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.size = SlotCount * ResolveSlotSize;
+        bufferDesc.usage = wgpu::BufferUsage::QueryResolve | wgpu::BufferUsage::CopySrc;
+        bufferDesc.mappedAtCreation = false;
+        m_ResolveBuffer = device.createBuffer(bufferDesc);
+
+        bufferDesc.size = QueriesPerSlot * sizeof(uint64_t);
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::MapRead;
+        for (Slot& slot : m_Slots) {
+            slot.readbackBuffer = device.createBuffer(bufferDesc);
+        }
+
+        return true;
+    }
+
+    void GpuTimer::Terminate() {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        // Destroying a buffer that is being mapped cancels the mapping, its callback then refers to a slot that is
+        // kept alive along with the timer.
+        for (Slot& slot : m_Slots) {
+            slot.readbackBuffer.destroy();
+            slot.readbackBuffer.release();
+            slot.readbackBuffer = nullptr;
+        }
+
+        m_ResolveBuffer.destroy();
+        m_ResolveBuffer.release();
+        m_ResolveBuffer = nullptr;
+
+        m_QuerySet.destroy();
+        m_QuerySet.release();
+        m_QuerySet = nullptr;
+    }
+
+    bool GpuTimer::IsEnabled() const {
+        return m_QuerySet;
+    }
+
+    const wgpu::RenderPassTimestampWrites* GpuTimer::BeginPass(const std::string_view name) {
+        if (!IsEnabled() || m_CurrentFrameSkipped) {
+            return nullptr;
+        }
+
+        if (!m_CurrentSlot) {
+            const auto slot = std::ranges::find(m_Slots, SlotState::Available, &Slot::state);
+            if (slot == m_Slots.end()) {
+                m_CurrentFrameSkipped = true;
+                return nullptr;
+            }
+
+            m_CurrentSlot = &*slot;
+            m_CurrentSlot->state = SlotState::Recording;
+            m_CurrentSlot->passCount = 0;
+        }
+
+        if (m_CurrentSlot->passCount == MaxPassCount) {
+            return nullptr;
+        }
+
+        const auto slotIndex = static_cast<uint32_t>(m_CurrentSlot - m_Slots.data());
+        const uint32_t firstQuery = slotIndex * QueriesPerSlot + 2 * m_CurrentSlot->passCount;
+        m_CurrentSlot->passNames[m_CurrentSlot->passCount++] = name;
+
+        m_TimestampWrites.querySet = m_QuerySet;
+        m_TimestampWrites.beginningOfPassWriteIndex = firstQuery;
+        m_TimestampWrites.endOfPassWriteIndex = firstQuery + 1;
+
+        return &m_TimestampWrites;
+    }
+
+    void GpuTimer::ResolveFrame(wgpu::CommandEncoder encoder) {
+        if (!m_CurrentSlot) {
+            return;
+        }
+
+        const auto slotIndex = static_cast<uint32_t>(m_CurrentSlot - m_Slots.data());
+        const uint32_t queryCount = 2 * m_CurrentSlot->passCount;
+        encoder.resolveQuerySet(m_QuerySet, slotIndex * QueriesPerSlot, queryCount, m_ResolveBuffer,
+                                slotIndex * ResolveSlotSize);
+        encoder.copyBufferToBuffer(m_ResolveBuffer, slotIndex * ResolveSlotSize, m_CurrentSlot->readbackBuffer, 0,
+                                   queryCount * sizeof(uint64_t));
+    }
+
+    void GpuTimer::EndFrame() {
+        if (m_CurrentSlot) {
+            Slot& slot = *m_CurrentSlot;
+            slot.frameIndex = m_FrameIndex;
+            slot.state = SlotState::Mapping;
+            // The C entry point takes the slot as is, where the wrapper would allocate a std::function every frame.
+            wgpuBufferMapAsync(slot.readbackBuffer, wgpu::MapMode::Read, 0, 2 * slot.passCount * sizeof(uint64_t),
+                               &GpuTimer::OnReadbackMapped, &slot);
+        }
+
+        m_CurrentSlot = nullptr;
+        m_CurrentFrameSkipped = false;
+        ++m_FrameIndex;
+    }
+
+    void GpuTimer::Update(std::pmr::vector<FrameTiming>& completedFrames) {
+        for (Slot& slot : m_Slots) {
+            if (slot.state == SlotState::MapFailed) {
+                slot.state = SlotState::Available;
+                continue;
+            }
+
+            if (slot.state != SlotState::Mapped) {
+                continue;
+            }
+
+            const size_t size = 2 * slot.passCount * sizeof(uint64_t);
+            std::array<uint64_t, QueriesPerSlot> timestamps{};
+            std::memcpy(timestamps.data(), slot.readbackBuffer.getConstMappedRange(0, size), size);
+            slot.readbackBuffer.unmap();
+            slot.state = SlotState::Available;
+
+            // Timestamps are in nanoseconds. Some implementations can report an end before the beginning when the
+            // pass is very short, which is clamped to 0.
+            FrameTiming frameTiming{slot.frameIndex, 0.0};
+            const bool latest = m_LatestPassCount == 0 || slot.frameIndex >= m_LatestFrameIndex;
+            for (uint32_t pass = 0; pass < slot.passCount; ++pass) {
+                const uint64_t begin = timestamps[2 * pass];
+                const uint64_t end = timestamps[2 * pass + 1];
+                const double duration = end > begin ? static_cast<double>(end - begin) / 1e6 : 0.0;
+                frameTiming.duration += duration;
+
+                if (latest) {
+                    m_LatestPassTimings[pass] = {slot.passNames[pass], duration};
+                }
+            }
+
+            if (latest) {
+                m_LatestPassCount = slot.passCount;
+                m_LatestFrameIndex = slot.frameIndex;
+            }
+
+            completedFrames.push_back(frameTiming);
+        }
+
+        // The slots may complete in any order.
+        std::ranges::sort(completedFrames, {}, &FrameTiming::frameIndex);
+    }
+
+    void GpuTimer::OnReadbackMapped(const WGPUBufferMapAsyncStatus status, void* userdata) {
+        Slot& slot = *static_cast<Slot*>(userdata);
+        slot.state = status == WGPUBufferMapAsyncStatus_Success ? SlotState::Mapped : SlotState::MapFailed;
+    }
+
+    uint64_t GpuTimer::GetFrameIndex() const {
+        return m_FrameIndex;
+    }
+
+    std::span<const GpuTimer::PassTiming> GpuTimer::GetLatestPassTimings() const {
+        return std::span<const PassTiming>(m_LatestPassTimings).first(m_LatestPassCount);
+    }
+}
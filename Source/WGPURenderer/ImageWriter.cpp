@@ -0,0 +1,162 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/ImageWriter.hpp>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr size_t PixelSize = 4;
+
+        uint32_t UpdateCrc32(uint32_t crc, const std::span<const uint8_t> data) {
+            static const std::array<uint32_t, 256> table = [] {
+                std::array<uint32_t, 256> entries{};
+                for (uint32_t i = 0; i < entries.size(); ++i) {
+                    uint32_t value = i;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        value = (value & 1) != 0 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                    }
+                    entries[i] = value;
+                }
+                return entries;
+            }();
+
+            for (const uint8_t byte : data) {
+                crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+            }
+
+            return crc;
+        }
+
+        void AppendBigEndian(std::vector<uint8_t>& out, const uint32_t value) {
+            out.push_back(static_cast<uint8_t>(value >> 24));
+            out.push_back(static_cast<uint8_t>(value >> 16));
+            out.push_back(static_cast<uint8_t>(value >> 8));
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void AppendChunk(std::vector<uint8_t>& out, const std::string_view type, const std::span<const uint8_t> data) {
+            AppendBigEndian(out, static_cast<uint32_t>(data.size()));
+
+            const size_t typeOffset = out.size();
+            out.insert(out.end(), type.begin(), type.end());
+            out.insert(out.end(), data.begin(), data.end());
+
+            // The CRC covers the type and the data, not the length.
+            const uint32_t crc = UpdateCrc32(0xFFFFFFFFu, std::span(out).subspan(typeOffset)) ^ 0xFFFFFFFFu;
+            AppendBigEndian(out, crc);
+        }
+
+        bool WriteFile(const std::filesystem::path& path, const std::span<const uint8_t> data) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            file.close();
+
+            return !file.fail();
+        }
+    }
+
+    bool ImageWriter::Write(const std::filesystem::path& path, const uint32_t width, const uint32_t height,
+                            const std::span<const uint8_t> pixels) {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](const char c) {
+            return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        });
+
+        if (extension == ".png") {
+            return WritePNG(path, width, height, pixels);
+        }
+
+        if (extension == ".ppm") {
+            return WritePPM(path, width, height, pixels);
+        }
+
+        return false;
+    }
+
+    bool ImageWriter::WritePPM(const std::filesystem::path& path, const uint32_t width, const uint32_t height,
+                               const std::span<const uint8_t> pixels) {
+        if (pixels.size() != static_cast<size_t>(width) * height * PixelSize) {
+            return false;
+        }
+
+        const std::string header = "P6\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+
+        std::vector<uint8_t> data(header.begin(), header.end());
+        data.reserve(header.size() + pixels.size() / PixelSize * 3);
+        for (size_t i = 0; i < pixels.size(); i += PixelSize) {
+            data.insert(data.end(), pixels.begin() + static_cast<ptrdiff_t>(i),
+                        pixels.begin() + static_cast<ptrdiff_t>(i + 3));
+        }
+
+        return WriteFile(path, data);
+    }
+
+    bool ImageWriter::WritePNG(const std::filesystem::path& path, const uint32_t width, const uint32_t height,
+                               const std::span<const uint8_t> pixels) {
+        const size_t rowSize = static_cast<size_t>(width) * PixelSize;
+        if (pixels.size() != rowSize * height) {
+            return false;
+        }
+
+        // Every scanline starts with its filter type, 0 being none.
+        std::vector<uint8_t> scanlines;
+        scanlines.reserve((rowSize + 1) * height);
+        for (uint32_t y = 0; y < height; ++y) {
+            scanlines.push_back(0);
+            const auto row = pixels.subspan(y * rowSize, rowSize);
+            scanlines.insert(scanlines.end(), row.begin(), row.end());
+        }
+
+        // zlib stream made of stored deflate blocks of at most 65535 bytes, followed by the Adler-32 checksum.
+        constexpr size_t MaxStoredBlockSize = 65535;
+        std::vector<uint8_t> compressed = {0x78, 0x01};
+        compressed.reserve(scanlines.size() + (scanlines.size() / MaxStoredBlockSize + 1) * 5 + 6);
+
+        size_t offset = 0;
+        do {
+            const size_t blockSize = std::min(MaxStoredBlockSize, scanlines.size() - offset);
+            const bool lastBlock = offset + blockSize == scanlines.size();
+            compressed.push_back(lastBlock ? 1 : 0);
+            compressed.push_back(static_cast<uint8_t>(blockSize));
+            compressed.push_back(static_cast<uint8_t>(blockSize >> 8));
+            compressed.push_back(static_cast<uint8_t>(~blockSize));
+            compressed.push_back(static_cast<uint8_t>(~blockSize >> 8));
+            compressed.insert(compressed.end(), scanlines.begin() + static_cast<ptrdiff_t>(offset),
+                              scanlines.begin() + static_cast<ptrdiff_t>(offset + blockSize));
+            offset += blockSize;
+        } while (offset < scanlines.size());
+
+        uint32_t adlerA = 1;
+        uint32_t adlerB = 0;
+        for (const uint8_t byte : scanlines) {
+            adlerA = (adlerA + byte) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        AppendBigEndian(compressed, (adlerB << 16) | adlerA);
+
+        // 8-bit RGBA, no interlacing.
+        std::vector<uint8_t> header;
+        AppendBigEndian(header, width);
+        AppendBigEndian(header, height);
+        header.insert(header.end(), {8, 6, 0, 0, 0});
+
+        std::vector<uint8_t> data = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        AppendChunk(data, "IHDR", header);
+        AppendChunk(data, "IDAT", compressed);
+        AppendChunk(data, "IEND", {});
+
+        return WriteFile(path, data);
+    }
+}
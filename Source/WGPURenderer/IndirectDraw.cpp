@@ -0,0 +1,258 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/IndirectDraw.hpp>
+#include <WGPURenderer/Profiler.hpp>
+#include <WGPURenderer/ResourceManager.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+namespace WGPURenderer {
+    namespace {
+        // WebGPU's default limit of workgroups per dimension.
+        constexpr uint32_t MaxWorkgroupCountPerDimension = 65535;
+    }
+
+    bool IndirectDraw::Initialize(wgpu::Device device, wgpu::Queue queue, const bool gpuCulling) {
+        m_Device = device;
+        m_Queue = queue;
+
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        bufferDesc.label = "Indirect draw arguments";
+#else
+        bufferDesc.label = nullptr;
+#endif
+        bufferDesc.size = sizeof(DrawArguments);
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Indirect | wgpu::BufferUsage::Storage;
+        bufferDesc.mappedAtCreation = false;
+        m_ArgumentBuffer = m_Device.createBuffer(bufferDesc);
+
+        if (!m_ArgumentBuffer) {
+            return false;
+        }
+
+        m_GpuCulling = gpuCulling;
+        return !m_GpuCulling || InitializeCulling();
+    }
+
+    void IndirectDraw::Terminate() {
+        if (m_CullBindGroup) {
+            m_CullBindGroup.release();
+            m_CullBindGroup = nullptr;
+        }
+
+        if (m_BoundInstanceBuffer) {
+            m_BoundInstanceBuffer.release();
+            m_BoundInstanceBuffer = nullptr;
+        }
+
+        if (m_VisibleInstanceBuffer) {
+            m_VisibleInstanceBuffer.release();
+            m_VisibleInstanceBuffer = nullptr;
+        }
+
+        if (m_CullParamsBuffer) {
+            m_CullParamsBuffer.release();
+            m_CullParamsBuffer = nullptr;
+        }
+
+        if (m_CullPipeline) {
+            m_CullPipeline.release();
+            m_CullPipeline = nullptr;
+        }
+
+        if (m_ArgumentBuffer) {
+            m_ArgumentBuffer.release();
+            m_ArgumentBuffer = nullptr;
+        }
+    }
+
+    bool IndirectDraw::Prepare(wgpu::CommandEncoder encoder, const InstanceBuffer& instances, const MeshRange& mesh,
+                               const float meshRadius, const float aspectRatio) {
+        WR_PROFILE_SCOPE("IndirectDraw::Prepare");
+
+        const uint32_t instanceCount = instances.GetUploadedCount();
+
+        // The culling pass counts the visible instances itself, starting from 0. Writes to the queue happen before
+        // the frame's submission, and after the previous frames that used the arguments.
+        DrawArguments arguments{};
+        arguments.indexCount = mesh.indexCount;
+        arguments.instanceCount = m_GpuCulling ? 0 : instanceCount;
+        arguments.firstIndex = mesh.firstIndex;
+        arguments.baseVertex = mesh.baseVertex;
+        arguments.firstInstance = 0;
+        m_Queue.writeBuffer(m_ArgumentBuffer, 0, &arguments, sizeof(arguments));
+
+        if (!m_GpuCulling || instanceCount == 0) {
+            return true;
+        }
+
+        if (!UpdateCullingBindGroup(instances)) {
+            return false;
+        }
+
+        CullParams params{};
+        params.instanceCount = instanceCount;
+        params.meshRadius = meshRadius;
+        params.aspectRatio = aspectRatio;
+        params.padding = 0;
+        m_Queue.writeBuffer(m_CullParamsBuffer, 0, &params, sizeof(params));
+
+        wgpu::ComputePassDescriptor computePassDesc{};
+        computePassDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        computePassDesc.label = "Culling pass";
+#else
+        computePassDesc.label = nullptr;
+#endif
+        computePassDesc.timestampWrites = nullptr;
+
+        const uint32_t workgroupCount = (instanceCount + WorkgroupSize - 1) / WorkgroupSize;
+        const uint32_t workgroupCountX = std::min(workgroupCount, MaxWorkgroupCountPerDimension);
+        const uint32_t workgroupCountY = (workgroupCount + workgroupCountX - 1) / workgroupCountX;
+
+        wgpu::ComputePassEncoder computePass = encoder.beginComputePass(computePassDesc);
+        computePass.setPipeline(m_CullPipeline);
+        computePass.setBindGroup(0, m_CullBindGroup, 0, nullptr);
+        computePass.dispatchWorkgroups(workgroupCountX, workgroupCountY, 1);
+        computePass.end();
+        computePass.release();
+
+        return true;
+    }
+
+    void IndirectDraw::Draw(wgpu::RenderPassEncoder renderPass, const InstanceBuffer& instances) {
+        if (m_GpuCulling) {
+            // Prepare only creates the visible instance buffer once there are instances to cull.
+            if (!m_VisibleInstanceBuffer) {
+                return;
+            }
+
+            renderPass.setVertexBuffer(1, m_VisibleInstanceBuffer, 0, m_VisibleInstanceBuffer.getSize());
+        } else {
+            renderPass.setVertexBuffer(1, instances.GetBuffer(), 0, instances.GetSize());
+        }
+
+        renderPass.drawIndexedIndirect(m_ArgumentBuffer, 0);
+    }
+
+    bool IndirectDraw::IsGpuCullingEnabled() const {
+        return m_GpuCulling;
+    }
+
+    bool IndirectDraw::InitializeCulling() {
+        wgpu::ShaderModule shaderModule = ResourceManager::LoadShaderModule("cull.wgsl", m_Device);
+
+        if (!shaderModule) {
+            std::cerr << "Couldn't load culling shader!\n";
+            return false;
+        }
+
+        wgpu::ComputePipelineDescriptor pipelineDesc{};
+        pipelineDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        pipelineDesc.label = "Culling pipeline";
+#else
+        pipelineDesc.label = nullptr;
+#endif
+        // The layout is deduced from the shader.
+        pipelineDesc.layout = nullptr;
+        pipelineDesc.compute.module = shaderModule;
+        pipelineDesc.compute.entryPoint = "cs_main";
+        pipelineDesc.compute.constantCount = 0;
+        pipelineDesc.compute.constants = nullptr;
+        m_CullPipeline = m_Device.createComputePipeline(pipelineDesc);
+
+        shaderModule.release();
+
+        if (!m_CullPipeline) {
+            std::cerr << "Failed to create culling pipeline!\n";
+            return false;
+        }
+
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.size = sizeof(CullParams);
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform;
+        bufferDesc.mappedAtCreation = false;
+        m_CullParamsBuffer = m_Device.createBuffer(bufferDesc);
+
+        return m_CullParamsBuffer;
+    }
+
+    bool IndirectDraw::UpdateCullingBindGroup(const InstanceBuffer& instances) {
+        wgpu::Buffer instanceBuffer = instances.GetBuffer();
+        if (instanceBuffer == m_BoundInstanceBuffer) {
+            return true;
+        }
+
+        // The visible instances can be as many as the instances, so the buffer follows the instance buffer's size.
+        if (m_VisibleInstanceBuffer) {
+            m_VisibleInstanceBuffer.release();
+        }
+
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        bufferDesc.label = "Visible instance buffer";
+#else
+        bufferDesc.label = nullptr;
+#endif
+        bufferDesc.size = instanceBuffer.getSize();
+        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::Vertex;
+        bufferDesc.mappedAtCreation = false;
+        m_VisibleInstanceBuffer = m_Device.createBuffer(bufferDesc);
+
+        if (!m_VisibleInstanceBuffer) {
+            return false;
+        }
+
+        std::array<wgpu::BindGroupEntry, 4> bindings{};
+        bindings[0].binding = 0;
+        bindings[0].buffer = m_CullParamsBuffer;
+        bindings[0].offset = 0;
+        bindings[0].size = sizeof(CullParams);
+
+        bindings[1].binding = 1;
+        bindings[1].buffer = instanceBuffer;
+        bindings[1].offset = 0;
+        bindings[1].size = instanceBuffer.getSize();
+
+        bindings[2].binding = 2;
+        bindings[2].buffer = m_VisibleInstanceBuffer;
+        bindings[2].offset = 0;
+        bindings[2].size = m_VisibleInstanceBuffer.getSize();
+
+        bindings[3].binding = 3;
+        bindings[3].buffer = m_ArgumentBuffer;
+        bindings[3].offset = 0;
+        bindings[3].size = sizeof(DrawArguments);
+
+        wgpu::BindGroupLayout bindGroupLayout = m_CullPipeline.getBindGroupLayout(0);
+
+        wgpu::BindGroupDescriptor bindGroupDesc{};
+        bindGroupDesc.layout = bindGroupLayout;
+        bindGroupDesc.entryCount = bindings.size();
+        bindGroupDesc.entries = bindings.data();
+
+        if (m_CullBindGroup) {
+            m_CullBindGroup.release();
+        }
+        m_CullBindGroup = m_Device.createBindGroup(bindGroupDesc);
+
+        bindGroupLayout.release();
+
+        // Holds a reference on the bound buffer, so that its handle can't be reused by another buffer unnoticed.
+        if (m_BoundInstanceBuffer) {
+            m_BoundInstanceBuffer.release();
+        }
+        instanceBuffer.reference();
+        m_BoundInstanceBuffer = instanceBuffer;
+
+        return m_CullBindGroup;
+    }
+}
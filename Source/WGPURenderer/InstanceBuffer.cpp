@@ -0,0 +1,143 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/InstanceBuffer.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+namespace WGPURenderer {
+    static_assert(sizeof(InstanceData) == 20, "InstanceData must match the instance vertex layout");
+
+    void InstanceBuffer::Terminate() {
+        if (m_Buffer) {
+            m_Buffer.release();
+            m_Buffer = nullptr;
+        }
+
+        m_Capacity = 0;
+        m_UploadedCount = 0;
+    }
+
+    uint32_t InstanceBuffer::AddInstance(const InstanceData& instance) {
+        const size_t index = m_Instances.size();
+        m_Instances.push_back(instance);
+
+        m_DirtyBegin = m_DirtyBegin < m_DirtyEnd ? std::min(m_DirtyBegin, index) : index;
+        m_DirtyEnd = index + 1;
+
+        return static_cast<uint32_t>(index);
+    }
+
+    void InstanceBuffer::UpdateInstance(const uint32_t index, const InstanceData& instance) {
+        m_Instances[index] = instance;
+
+        if (m_DirtyBegin < m_DirtyEnd) {
+            m_DirtyBegin = std::min<size_t>(m_DirtyBegin, index);
+            m_DirtyEnd = std::max<size_t>(m_DirtyEnd, index + 1);
+        } else {
+            m_DirtyBegin = index;
+            m_DirtyEnd = index + 1;
+        }
+    }
+
+    void InstanceBuffer::Clear() {
+        m_Instances.clear();
+        m_UploadedCount = 0;
+        m_DirtyBegin = 0;
+        m_DirtyEnd = 0;
+    }
+
+    bool InstanceBuffer::Upload(wgpu::Device device, StagingBelt& stagingBelt) {
+        WR_PROFILE_SCOPE("InstanceBuffer::Upload");
+
+        if (m_Instances.size() > m_Capacity) {
+            // The frames in flight keep the previous buffer alive until they complete.
+            if (m_Buffer) {
+                m_Buffer.release();
+            }
+
+            m_Capacity = std::bit_ceil(m_Instances.size());
+
+            wgpu::BufferDescriptor bufferDesc{};
+            bufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+            bufferDesc.label = "Instance buffer";
+#else
+            bufferDesc.label = nullptr;
+#endif
+            bufferDesc.size = m_Capacity * sizeof(InstanceData);
+            // Storage so that the culling pass can read the instances.
+            bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex | wgpu::BufferUsage::Storage;
+            bufferDesc.mappedAtCreation = false;
+            m_Buffer = device.createBuffer(bufferDesc);
+
+            if (!m_Buffer) {
+                m_Capacity = 0;
+                m_UploadedCount = 0;
+                return false;
+            }
+
+            // The new buffer has none of the instances yet.
+            m_UploadedCount = 0;
+            m_DirtyBegin = 0;
+            m_DirtyEnd = m_Instances.size();
+        }
+
+        if (m_DirtyBegin >= m_DirtyEnd) {
+            return true;
+        }
+
+        const size_t uploadCount =
+            std::min<uint64_t>(m_DirtyEnd - m_DirtyBegin, stagingBelt.GetRemainingBudget() / sizeof(InstanceData));
+        const uint64_t uploadSize = uploadCount * sizeof(InstanceData);
+        void* stagingData = uploadCount > 0
+                                ? stagingBelt.Upload(m_Buffer, m_DirtyBegin * sizeof(InstanceData), uploadSize)
+                                : nullptr;
+
+        if (stagingData) {
+            std::memcpy(stagingData, m_Instances.data() + m_DirtyBegin, uploadSize);
+
+            // The instances before the dirty range are uploaded already, or it wouldn't start there.
+            m_UploadedCount = std::max(m_UploadedCount, m_DirtyBegin + uploadCount);
+            m_DirtyBegin += uploadCount;
+            if (m_DirtyBegin == m_DirtyEnd) {
+                m_DirtyBegin = 0;
+                m_DirtyEnd = 0;
+            }
+        }
+
+        return true;
+    }
+
+    uint32_t InstanceBuffer::GetInstanceCount() const {
+        return static_cast<uint32_t>(m_Instances.size());
+    }
+
+    uint32_t InstanceBuffer::GetUploadedCount() const {
+        return static_cast<uint32_t>(m_UploadedCount);
+    }
+
+    wgpu::Buffer InstanceBuffer::GetBuffer() const {
+        return m_Buffer;
+    }
+
+    uint64_t InstanceBuffer::GetSize() const {
+        return m_UploadedCount * sizeof(InstanceData);
+    }
+
+    void InstanceBuffer::BuildVertexAttributes(std::array<wgpu::VertexAttribute, AttributeCount>& attributes) {
+        // Offset, scale and rotation are read as a single vec4f.
+        attributes[0].format = wgpu::VertexFormat::Float32x4;
+        attributes[0].offset = offsetof(InstanceData, offset);
+        attributes[0].shaderLocation = FirstShaderLocation;
+
+        attributes[1].format = wgpu::VertexFormat::Unorm8x4;
+        attributes[1].offset = offsetof(InstanceData, color);
+        attributes[1].shaderLocation = FirstShaderLocation + 1;
+    }
+}
@@ -0,0 +1,327 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/JobSystem.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr uint32_t NoThreadIndex = ~0u;
+
+        // Chase-Lev work-stealing deque of fixed capacity. The owner pushes and pops at the bottom, thieves steal at
+        // the top. Sequentially consistent accesses to the indices stand for the fences of the original algorithm,
+        // which keeps it within what ThreadSanitizer understands.
+        class JobDeque {
+        public:
+            // Owner only. Returns false if the deque is full.
+            bool Push(Job* job) {
+                const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+                const int64_t top = m_Top.load(std::memory_order_acquire);
+                if (bottom - top >= static_cast<int64_t>(JobSystem::DequeCapacity)) {
+                    return false;
+                }
+
+                m_Jobs[bottom & IndexMask].store(job, std::memory_order_relaxed);
+                m_Bottom.store(bottom + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Owner only, takes the most recently pushed job.
+            Job* Pop() {
+                const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+                m_Bottom.store(bottom, std::memory_order_seq_cst);
+                int64_t top = m_Top.load(std::memory_order_seq_cst);
+
+                if (top > bottom) {
+                    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                Job* job = m_Jobs[bottom & IndexMask].load(std::memory_order_relaxed);
+                if (top == bottom) {
+                    // Last job, the thieves may be after it as well.
+                    if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                       std::memory_order_relaxed)) {
+                        job = nullptr;
+                    }
+
+                    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+
+                return job;
+            }
+
+            // Any thread, takes the least recently pushed job. Returns nullptr when empty or when another thread
+            // took the job first.
+            Job* Steal() {
+                int64_t top = m_Top.load(std::memory_order_seq_cst);
+                const int64_t bottom = m_Bottom.load(std::memory_order_seq_cst);
+                if (top >= bottom) {
+                    return nullptr;
+                }
+
+                Job* job = m_Jobs[top & IndexMask].load(std::memory_order_relaxed);
+                if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed)) {
+                    return nullptr;
+                }
+
+                return job;
+            }
+
+        private:
+            static constexpr int64_t IndexMask = JobSystem::DequeCapacity - 1;
+            static_assert((JobSystem::DequeCapacity & IndexMask) == 0, "The capacity must be a power of two");
+
+            // On their own cache lines, the owner writes the bottom while the thieves write the top.
+            alignas(64) std::atomic<int64_t> m_Top = 0;
+            alignas(64) std::atomic<int64_t> m_Bottom = 0;
+            std::array<std::atomic<Job*>, JobSystem::DequeCapacity> m_Jobs{};
+        };
+
+        struct JobSystemState {
+            // Index 0 belongs to the main thread, the workers follow.
+            std::unique_ptr<JobDeque[]> deques;
+            uint32_t threadCount = 1;
+            std::vector<std::thread> workers;
+
+            // Jobs submitted by threads outside the system, a ring of fixed capacity that starts at the head.
+            std::mutex sharedQueueMutex;
+            std::array<Job*, JobSystem::DequeCapacity> sharedQueue{};
+            uint32_t sharedQueueHead = 0;
+            std::atomic<uint32_t> sharedQueueSize = 0;
+
+            // Jobs queued and not taken yet, the idle workers sleep while there are none.
+            std::atomic<int64_t> pendingJobCount = 0;
+            std::atomic<uint32_t> sleepingWorkerCount = 0;
+            std::mutex sleepMutex;
+            std::condition_variable wakeUp;
+            std::atomic<bool> stopping = false;
+        };
+
+        JobSystemState s_State;
+        thread_local uint32_t t_ThreadIndex = NoThreadIndex;
+
+        // Returns false if the queue is full.
+        bool PushSharedJob(Job* job) {
+            std::lock_guard lock(s_State.sharedQueueMutex);
+            const uint32_t size = s_State.sharedQueueSize.load(std::memory_order_relaxed);
+            if (size == JobSystem::DequeCapacity) {
+                return false;
+            }
+
+            s_State.sharedQueue[(s_State.sharedQueueHead + size) % JobSystem::DequeCapacity] = job;
+            s_State.sharedQueueSize.store(size + 1, std::memory_order_release);
+            return true;
+        }
+
+        Job* TakeSharedJob() {
+            if (s_State.sharedQueueSize.load(std::memory_order_acquire) == 0) {
+                return nullptr;
+            }
+
+            std::lock_guard lock(s_State.sharedQueueMutex);
+            const uint32_t size = s_State.sharedQueueSize.load(std::memory_order_relaxed);
+            if (size == 0) {
+                return nullptr;
+            }
+
+            Job* job = s_State.sharedQueue[s_State.sharedQueueHead];
+            s_State.sharedQueueHead = (s_State.sharedQueueHead + 1) % JobSystem::DequeCapacity;
+            s_State.sharedQueueSize.store(size - 1, std::memory_order_release);
+            return job;
+        }
+
+        Job* FindJob() {
+            const uint32_t threadIndex = t_ThreadIndex;
+            Job* job = threadIndex != NoThreadIndex ? s_State.deques[threadIndex].Pop() : nullptr;
+            if (!job) {
+                job = TakeSharedJob();
+            }
+
+            // Stealing starts after the thread's own deque, so that the thieves spread over the victims.
+            const uint32_t firstVictim = threadIndex != NoThreadIndex ? threadIndex + 1 : 0;
+            for (uint32_t i = 0; !job && i < s_State.threadCount; ++i) {
+                const uint32_t victim = (firstVictim + i) % s_State.threadCount;
+                if (victim != threadIndex) {
+                    job = s_State.deques[victim].Steal();
+                }
+            }
+
+            if (job) {
+                s_State.pendingJobCount.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            return job;
+        }
+
+        void WakeWorkers(const int64_t jobCount) {
+            // Paired with the sleeping workers, which count themselves before checking for pending jobs: either
+            // they see the jobs, or the jobs are submitted after they are counted and they get notified.
+            s_State.pendingJobCount.fetch_add(jobCount, std::memory_order_seq_cst);
+            if (s_State.sleepingWorkerCount.load(std::memory_order_seq_cst) == 0) {
+                return;
+            }
+
+            {
+                std::lock_guard lock(s_State.sleepMutex);
+            }
+
+            if (jobCount == 1) {
+                s_State.wakeUp.notify_one();
+            } else {
+                s_State.wakeUp.notify_all();
+            }
+        }
+    }
+
+    JobCounter::JobCounter(Job& continuation, JobCounter& continuationCounter)
+        : m_Continuation(&continuation) {
+        continuation.counter = &continuationCounter;
+        continuationCounter.m_Count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool JobCounter::IsDone() const {
+        return m_Count.load(std::memory_order_acquire) == 0;
+    }
+
+    void JobSystem::Initialize(uint32_t workerCount) {
+        if (workerCount == 0) {
+            workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+        }
+
+        workerCount = std::min(workerCount, MaxWorkerCount);
+        if (workerCount == 0) {
+            return;
+        }
+
+        s_State.threadCount = workerCount + 1;
+        s_State.deques = std::make_unique<JobDeque[]>(s_State.threadCount);
+        s_State.stopping = false;
+        t_ThreadIndex = 0;
+
+        s_State.workers.reserve(workerCount);
+        for (uint32_t i = 1; i <= workerCount; ++i) {
+            s_State.workers.emplace_back(&JobSystem::RunWorker, i);
+        }
+    }
+
+    void JobSystem::Terminate() {
+        {
+            std::lock_guard lock(s_State.sleepMutex);
+            s_State.stopping = true;
+        }
+
+        s_State.wakeUp.notify_all();
+        for (std::thread& worker : s_State.workers) {
+            worker.join();
+        }
+
+        s_State.workers.clear();
+        s_State.deques.reset();
+        s_State.threadCount = 1;
+        s_State.pendingJobCount = 0;
+        t_ThreadIndex = NoThreadIndex;
+    }
+
+    void JobSystem::Run(const std::span<Job> jobs, JobCounter& counter) {
+        if (jobs.empty()) {
+            if (counter.m_Continuation) {
+                Schedule(*counter.m_Continuation);
+            }
+            return;
+        }
+
+        // Counted upfront, so that the counter doesn't reach zero while the batch is being queued.
+        counter.m_Count.fetch_add(static_cast<uint32_t>(jobs.size()), std::memory_order_relaxed);
+
+        int64_t queuedCount = 0;
+        for (Job& job : jobs) {
+            job.counter = &counter;
+            queuedCount += Enqueue(job) ? 1 : 0;
+        }
+
+        if (queuedCount > 0) {
+            WakeWorkers(queuedCount);
+        }
+    }
+
+    void JobSystem::Wait(const JobCounter& counter) {
+        WR_PROFILE_SCOPE("JobSystem::Wait");
+
+        while (!counter.IsDone()) {
+            if (Job* job = FindJob()) {
+                Execute(*job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    uint32_t JobSystem::GetThreadCount() {
+        return s_State.threadCount;
+    }
+
+    void JobSystem::RunWorker(const uint32_t threadIndex) {
+        WR_PROFILE_THREAD("Job worker");
+        t_ThreadIndex = threadIndex;
+
+        while (true) {
+            if (Job* job = FindJob()) {
+                Execute(*job);
+                continue;
+            }
+
+            std::unique_lock lock(s_State.sleepMutex);
+            s_State.sleepingWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+            s_State.wakeUp.wait(lock, [] {
+                return s_State.pendingJobCount.load(std::memory_order_seq_cst) > 0 ||
+                       s_State.stopping.load(std::memory_order_relaxed);
+            });
+            s_State.sleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
+
+            if (s_State.stopping.load(std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    void JobSystem::Execute(Job& job) {
+        job.function(job.data, job.begin, job.end);
+
+        // Once the counter reaches zero, its owner may destroy it, so the continuation is read beforehand.
+        JobCounter& counter = *job.counter;
+        Job* continuation = counter.m_Continuation;
+        if (counter.m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1 && continuation) {
+            Schedule(*continuation);
+        }
+    }
+
+    bool JobSystem::Enqueue(Job& job) {
+        if (!s_State.deques) {
+            Execute(job);
+            return false;
+        }
+
+        const bool queued = t_ThreadIndex == NoThreadIndex ? PushSharedJob(&job)
+                                                           : s_State.deques[t_ThreadIndex].Push(&job);
+        if (!queued) {
+            Execute(job);
+            return false;
+        }
+
+        return true;
+    }
+
+    void JobSystem::Schedule(Job& job) {
+        if (Enqueue(job)) {
+            WakeWorkers(1);
+        }
+    }
+}
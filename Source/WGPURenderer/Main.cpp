@@ -6,8 +6,13 @@
 
 #include <cstdlib>
 
-int main() {
-    WGPURenderer::Application app;
+int main(const int argc, char** argv) {
+    WGPURenderer::ApplicationConfig config;
+    if (!WGPURenderer::ApplicationConfig::ParseCommandLine(argc, argv, config)) {
+        return EXIT_FAILURE;
+    }
+
+    WGPURenderer::Application app(config);
 
     if (!app.Run()) {
         return EXIT_FAILURE;
@@ -0,0 +1,150 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/MappedFile.hpp>
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WGPURenderer {
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+
+            m_Data = std::exchange(other.m_Data, nullptr);
+            m_Size = std::exchange(other.m_Size, 0);
+            m_IsOpen = std::exchange(other.m_IsOpen, false);
+#ifdef _WIN32
+            m_FileHandle = std::exchange(other.m_FileHandle, nullptr);
+            m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+#endif
+        }
+
+        return *this;
+    }
+
+    bool MappedFile::Open(const std::filesystem::path& path) {
+        Close();
+
+#ifdef _WIN32
+        const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            return false;
+        }
+
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            m_IsOpen = true;
+            return true;
+        }
+
+        const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_FileHandle = file;
+        m_MappingHandle = mapping;
+        m_Data = static_cast<const std::byte*>(data);
+        m_Size = static_cast<size_t>(size.QuadPart);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat fileStat{};
+        if (fstat(fd, &fileStat) != 0) {
+            close(fd);
+            return false;
+        }
+
+        if (fileStat.st_size == 0) {
+            close(fd);
+            m_IsOpen = true;
+            return true;
+        }
+
+        const auto size = static_cast<size_t>(fileStat.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping stays valid once the descriptor is closed.
+        close(fd);
+
+        if (data == MAP_FAILED) {
+            return false;
+        }
+
+        m_Data = static_cast<const std::byte*>(data);
+        m_Size = size;
+#endif
+
+        m_IsOpen = true;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        // Empty files have no mapping.
+        if (m_Data) {
+#ifdef _WIN32
+            UnmapViewOfFile(m_Data);
+            CloseHandle(m_MappingHandle);
+            CloseHandle(m_FileHandle);
+            m_MappingHandle = nullptr;
+            m_FileHandle = nullptr;
+#else
+            munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+        }
+
+        m_Data = nullptr;
+        m_Size = 0;
+        m_IsOpen = false;
+    }
+
+    bool MappedFile::IsOpen() const {
+        return m_IsOpen;
+    }
+
+    std::span<const std::byte> MappedFile::GetData() const {
+        return {m_Data, m_Size};
+    }
+}
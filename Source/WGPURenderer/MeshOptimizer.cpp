@@ -0,0 +1,250 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/MeshOptimizer.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr uint32_t InvalidVertex = std::numeric_limits<uint32_t>::max();
+
+        // Triangles using each vertex, in compressed sparse row form.
+        struct VertexAdjacency {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> triangles;
+        };
+
+        VertexAdjacency BuildAdjacency(const std::span<const uint32_t> indices, const size_t vertexCount) {
+            VertexAdjacency adjacency;
+            adjacency.offsets.assign(vertexCount + 1, 0);
+            adjacency.triangles.resize(indices.size());
+
+            for (const uint32_t index : indices) {
+                ++adjacency.offsets[index + 1];
+            }
+
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                adjacency.offsets[vertex + 1] += adjacency.offsets[vertex];
+            }
+
+            std::vector<uint32_t> cursors(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                adjacency.triangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            return adjacency;
+        }
+
+        uint64_t HashVertex(const float* vertex, const size_t componentCount) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < componentCount; ++i) {
+                uint32_t bits;
+                std::memcpy(&bits, vertex + i, sizeof(bits));
+                hash = (hash ^ bits) * 0x100000001b3ull;
+            }
+
+            return hash ^ (hash >> 32);
+        }
+    }
+
+    size_t MeshOptimizer::WeldVertices(const std::span<uint32_t> indices, std::vector<float>& vertices,
+                                       const size_t componentCount) {
+        const size_t vertexCount = vertices.size() / componentCount;
+        const size_t vertexSize = componentCount * sizeof(float);
+
+        // Open addressing table of unique vertices, kept at most half full.
+        const size_t tableSize = std::bit_ceil(std::max<size_t>(vertexCount * 2, 16));
+        const size_t tableMask = tableSize - 1;
+        std::vector<uint32_t> table(tableSize, InvalidVertex);
+        std::vector<uint32_t> remap(vertexCount);
+
+        // Unique vertices are compacted in place: the destination never goes past the vertex being read.
+        uint32_t uniqueCount = 0;
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            const float* data = vertices.data() + vertex * componentCount;
+
+            size_t slot = HashVertex(data, componentCount) & tableMask;
+            while (table[slot] != InvalidVertex &&
+                   std::memcmp(vertices.data() + table[slot] * componentCount, data, vertexSize) != 0) {
+                slot = (slot + 1) & tableMask;
+            }
+
+            if (table[slot] == InvalidVertex) {
+                table[slot] = uniqueCount;
+                if (uniqueCount != vertex) {
+                    std::memcpy(vertices.data() + uniqueCount * componentCount, data, vertexSize);
+                }
+                ++uniqueCount;
+            }
+
+            remap[vertex] = table[slot];
+        }
+
+        for (uint32_t& index : indices) {
+            index = remap[index];
+        }
+
+        vertices.resize(uniqueCount * componentCount);
+
+        return uniqueCount;
+    }
+
+    VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const std::span<const uint32_t> indices,
+                                                            const size_t vertexCount, const size_t cacheSize) {
+        VertexCacheStatistics statistics;
+        if (indices.empty()) {
+            return statistics;
+        }
+
+        // A vertex is in the FIFO cache if less than `cacheSize` misses happened since it was last loaded.
+        std::vector<size_t> cacheTimes(vertexCount, 0);
+        std::vector<bool> used(vertexCount, false);
+        size_t time = cacheSize + 1;
+        size_t missCount = 0;
+        size_t usedCount = 0;
+
+        for (const uint32_t index : indices) {
+            if (time - cacheTimes[index] > cacheSize) {
+                cacheTimes[index] = time++;
+                ++missCount;
+            }
+
+            if (!used[index]) {
+                used[index] = true;
+                ++usedCount;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(missCount) / static_cast<float>(indices.size() / 3);
+        statistics.atvr = static_cast<float>(missCount) / static_cast<float>(usedCount);
+
+        return statistics;
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(const std::span<uint32_t> indices, const size_t vertexCount,
+                                            const size_t cacheSize) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        const VertexAdjacency adjacency = BuildAdjacency(indices, vertexCount);
+
+        std::vector<uint32_t> liveTriangleCounts(vertexCount);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            liveTriangleCounts[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+        }
+
+        std::vector<size_t> cacheTimes(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEndStack;
+        std::vector<uint32_t> candidates;
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+
+        size_t time = cacheSize + 1;
+        uint32_t scanCursor = 0;
+
+        // Picks a vertex that still has triangles to emit once the candidates are exhausted: the most recently
+        // touched one first, then any in input order.
+        const auto skipDeadEnd = [&]() -> uint32_t {
+            while (!deadEndStack.empty()) {
+                const uint32_t vertex = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveTriangleCounts[vertex] > 0) {
+                    return vertex;
+                }
+            }
+
+            for (; scanCursor < vertexCount; ++scanCursor) {
+                if (liveTriangleCounts[scanCursor] > 0) {
+                    return scanCursor;
+                }
+            }
+
+            return InvalidVertex;
+        };
+
+        uint32_t fanningVertex = skipDeadEnd();
+        while (fanningVertex != InvalidVertex) {
+            candidates.clear();
+
+            for (uint32_t i = adjacency.offsets[fanningVertex]; i < adjacency.offsets[fanningVertex + 1]; ++i) {
+                const uint32_t triangle = adjacency.triangles[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    output.push_back(vertex);
+                    deadEndStack.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveTriangleCounts[vertex];
+
+                    if (time - cacheTimes[vertex] > cacheSize) {
+                        cacheTimes[vertex] = time++;
+                    }
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // Prefer the candidate that will still be in the cache after emitting all of its remaining triangles,
+            // and among those the oldest one.
+            uint32_t nextVertex = InvalidVertex;
+            size_t bestPriority = 0;
+            for (const uint32_t vertex : candidates) {
+                if (liveTriangleCounts[vertex] == 0) {
+                    continue;
+                }
+
+                size_t priority = 1;
+                const size_t age = time - cacheTimes[vertex];
+                if (age + 2 * liveTriangleCounts[vertex] <= cacheSize) {
+                    priority += age;
+                }
+
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            fanningVertex = nextVertex != InvalidVertex ? nextVertex : skipDeadEnd();
+        }
+
+        std::ranges::copy(output, indices.begin());
+    }
+
+    size_t MeshOptimizer::OptimizeVertexFetch(const std::span<uint32_t> indices, std::vector<float>& vertices,
+                                              const size_t componentCount) {
+        const size_t vertexCount = vertices.size() / componentCount;
+
+        std::vector<uint32_t> remap(vertexCount, InvalidVertex);
+        std::vector<float> reordered;
+        reordered.reserve(vertices.size());
+
+        uint32_t nextVertex = 0;
+        for (uint32_t& index : indices) {
+            if (remap[index] == InvalidVertex) {
+                remap[index] = nextVertex++;
+
+                const auto first = vertices.begin() + static_cast<std::ptrdiff_t>(index * componentCount);
+                reordered.insert(reordered.end(), first, first + static_cast<std::ptrdiff_t>(componentCount));
+            }
+
+            index = remap[index];
+        }
+
+        vertices = std::move(reordered);
+
+        return nextVertex;
+    }
+}
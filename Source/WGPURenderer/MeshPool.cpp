@@ -0,0 +1,285 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/MeshPool.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <numeric>
+#include <span>
+#include <utility>
+
+namespace WGPURenderer {
+    namespace {
+        uint32_t AlignUp(const uint32_t value, const uint32_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    bool MeshPool::Initialize(wgpu::Device device, wgpu::Queue queue, const uint32_t vertexStride,
+                              const wgpu::IndexFormat indexFormat, const uint32_t vertexCapacity,
+                              const uint32_t indexCapacity) {
+        m_Device = device;
+        m_Queue = queue;
+        m_IndexFormat = indexFormat;
+
+        m_VertexPool.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::Vertex;
+        m_VertexPool.label = "Mesh pool vertex buffer";
+        m_IndexPool.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::Index;
+        m_IndexPool.label = "Mesh pool index buffer";
+
+        const uint32_t indexSize = static_cast<uint32_t>(Geometry::GetIndexSize(indexFormat));
+        if (vertexStride == 0 || indexSize == 0) {
+            std::cerr << "Invalid mesh pool layout!\n";
+            return false;
+        }
+
+        return InitializePool(m_VertexPool, vertexStride, vertexCapacity) &&
+               InitializePool(m_IndexPool, indexSize, indexCapacity);
+    }
+
+    void MeshPool::Terminate() {
+        TerminatePool(m_VertexPool);
+        TerminatePool(m_IndexPool);
+
+        m_Meshes.clear();
+        m_FreeHandles.clear();
+    }
+
+    MeshHandle MeshPool::AddMesh(const Geometry& geometry) {
+        WR_PROFILE_SCOPE("MeshPool::AddMesh");
+
+        if (geometry.GetVertexStride() != m_VertexPool.elementSize) {
+            std::cerr << "The mesh's vertex layout doesn't match the pool's!\n";
+            return InvalidMesh;
+        }
+
+        // 32-bit indices only fit 16-bit pools if they are narrowed, which the geometry already did when it could.
+        std::vector<uint32_t> widenedIndices;
+        std::span<const std::byte> indexData = geometry.GetIndexData();
+        if (geometry.GetIndexFormat() != m_IndexFormat) {
+            if (m_IndexFormat != wgpu::IndexFormat::Uint32) {
+                std::cerr << "The mesh's indices don't fit the pool's index format!\n";
+                return InvalidMesh;
+            }
+
+            const auto* shortIndices = reinterpret_cast<const uint16_t*>(indexData.data());
+            widenedIndices.assign(shortIndices, shortIndices + geometry.GetIndexCount());
+            indexData = std::as_bytes(std::span<const uint32_t>(widenedIndices));
+        }
+
+        const uint32_t vertexCount = static_cast<uint32_t>(geometry.GetVertexCount());
+        const uint32_t indexCount = static_cast<uint32_t>(geometry.GetIndexCount());
+
+        Mesh mesh;
+        mesh.indexCount = indexCount;
+        mesh.used = true;
+
+        if (!AllocateElements(m_VertexPool, vertexCount, mesh.vertices)) {
+            return InvalidMesh;
+        }
+
+        if (!AllocateElements(m_IndexPool, indexCount, mesh.indices)) {
+            m_VertexPool.allocator.Free(mesh.vertices);
+            return InvalidMesh;
+        }
+
+        m_Queue.writeBuffer(m_VertexPool.buffer, static_cast<uint64_t>(mesh.vertices.offset) * m_VertexPool.elementSize,
+                            geometry.GetVertexData().data(), geometry.GetVertexData().size_bytes());
+
+        // The writes must be multiples of 4 bytes. Geometries pad their 16-bit indices so that the padding is
+        // readable, and the allocation is padded the same way.
+        const uint64_t indexUploadSize = (indexData.size_bytes() + 3) & ~uint64_t{3};
+        m_Queue.writeBuffer(m_IndexPool.buffer, static_cast<uint64_t>(mesh.indices.offset) * m_IndexPool.elementSize,
+                            indexData.data(), indexUploadSize);
+
+        MeshHandle handle;
+        if (!m_FreeHandles.empty()) {
+            handle = m_FreeHandles.back();
+            m_FreeHandles.pop_back();
+            m_Meshes[handle] = mesh;
+        } else {
+            handle = static_cast<MeshHandle>(m_Meshes.size());
+            m_Meshes.push_back(mesh);
+        }
+
+        return handle;
+    }
+
+    void MeshPool::RemoveMesh(const MeshHandle mesh) {
+        if (mesh >= m_Meshes.size() || !m_Meshes[mesh].used) {
+            return;
+        }
+
+        m_VertexPool.allocator.Free(m_Meshes[mesh].vertices);
+        m_IndexPool.allocator.Free(m_Meshes[mesh].indices);
+        m_Meshes[mesh] = Mesh{};
+        m_FreeHandles.push_back(mesh);
+    }
+
+    bool MeshPool::Defragment() {
+        WR_PROFILE_SCOPE("MeshPool::Defragment");
+
+        return Relocate(m_VertexPool, m_VertexPool.allocator.GetCapacity(), true) &&
+               Relocate(m_IndexPool, m_IndexPool.allocator.GetCapacity(), true);
+    }
+
+    void MeshPool::Bind(wgpu::RenderPassEncoder renderPass) const {
+        renderPass.setVertexBuffer(0, m_VertexPool.buffer, 0, m_VertexPool.buffer.getSize());
+        renderPass.setIndexBuffer(m_IndexPool.buffer, m_IndexFormat, 0, m_IndexPool.buffer.getSize());
+    }
+
+    MeshRange MeshPool::GetMeshRange(const MeshHandle mesh) const {
+        MeshRange range;
+        if (mesh < m_Meshes.size() && m_Meshes[mesh].used) {
+            range.indexCount = m_Meshes[mesh].indexCount;
+            range.firstIndex = m_Meshes[mesh].indices.offset;
+            range.baseVertex = static_cast<int32_t>(m_Meshes[mesh].vertices.offset);
+        }
+
+        return range;
+    }
+
+    wgpu::IndexFormat MeshPool::GetIndexFormat() const {
+        return m_IndexFormat;
+    }
+
+    MeshPoolStatistics MeshPool::GetStatistics() const {
+        MeshPoolStatistics statistics;
+        statistics.meshCount = static_cast<uint32_t>(m_Meshes.size() - m_FreeHandles.size());
+        statistics.vertices = m_VertexPool.allocator.GetStatistics();
+        statistics.indices = m_IndexPool.allocator.GetStatistics();
+        return statistics;
+    }
+
+    bool MeshPool::InitializePool(Pool& pool, const uint32_t elementSize, const uint32_t capacity) {
+        pool.elementSize = elementSize;
+        pool.granularity = 4 / std::gcd(elementSize, 4u);
+        pool.allocator.Reset(0);
+
+        return Relocate(pool, AlignUp(std::max(capacity, 1u), pool.granularity), false);
+    }
+
+    void MeshPool::TerminatePool(Pool& pool) {
+        if (pool.buffer) {
+            pool.buffer.release();
+            pool.buffer = nullptr;
+        }
+
+        pool.allocator.Reset(0);
+    }
+
+    bool MeshPool::AllocateElements(Pool& pool, const uint32_t count, OffsetAllocator::Allocation& allocation) {
+        const uint32_t alignedCount = AlignUp(std::max(count, 1u), pool.granularity);
+        if (pool.allocator.Allocate(alignedCount, allocation)) {
+            return true;
+        }
+
+        // Packing the meshes turns scattered free space into a single region, which spares growing when it's enough.
+        if (pool.allocator.GetStatistics().freeSize >= alignedCount &&
+            Relocate(pool, pool.allocator.GetCapacity(), true) && pool.allocator.Allocate(alignedCount, allocation)) {
+            return true;
+        }
+
+        // Grows to the next power of two, the free region at the end then holds the allocation whatever the
+        // fragmentation.
+        const uint64_t capacity = std::bit_ceil(static_cast<uint64_t>(pool.allocator.GetCapacity()) + alignedCount);
+        if (capacity > std::numeric_limits<uint32_t>::max() ||
+            !Relocate(pool, static_cast<uint32_t>(capacity), false)) {
+            std::cerr << "Couldn't grow the mesh pool!\n";
+            return false;
+        }
+
+        return pool.allocator.Allocate(alignedCount, allocation);
+    }
+
+    bool MeshPool::Relocate(Pool& pool, const uint32_t capacity, const bool pack) {
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        bufferDesc.label = pool.label;
+#else
+        bufferDesc.label = nullptr;
+#endif
+        bufferDesc.size = static_cast<uint64_t>(capacity) * pool.elementSize;
+        bufferDesc.usage = pool.usage;
+        bufferDesc.mappedAtCreation = false;
+        wgpu::Buffer buffer = m_Device.createBuffer(bufferDesc);
+
+        if (!buffer) {
+            return false;
+        }
+
+        // Copies on the GPU, after the uploads already queued. A buffer can't be both the source and the
+        // destination of a copy, hence the new buffer even when the capacity stays the same.
+        if (pool.buffer && pool.allocator.GetStatistics().allocationCount > 0) {
+            wgpu::CommandEncoderDescriptor encoderDesc{};
+            encoderDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+            encoderDesc.label = "Mesh pool relocation";
+#else
+            encoderDesc.label = nullptr;
+#endif
+            wgpu::CommandEncoder encoder = m_Device.createCommandEncoder(encoderDesc);
+
+            if (pack) {
+                // Reallocating from an empty allocator in offset order lays the meshes out back to back.
+                std::vector<Mesh*> meshes;
+                for (Mesh& mesh : m_Meshes) {
+                    if (mesh.used) {
+                        meshes.push_back(&mesh);
+                    }
+                }
+
+                std::ranges::sort(meshes, [&](Mesh* lhs, Mesh* rhs) {
+                    return GetAllocation(*lhs, pool).offset < GetAllocation(*rhs, pool).offset;
+                });
+
+                pool.allocator.Reset(capacity);
+                for (Mesh* mesh : meshes) {
+                    OffsetAllocator::Allocation& allocation = GetAllocation(*mesh, pool);
+                    const uint32_t sourceOffset = allocation.offset;
+                    pool.allocator.Allocate(allocation.size, allocation);
+
+                    encoder.copyBufferToBuffer(pool.buffer, static_cast<uint64_t>(sourceOffset) * pool.elementSize,
+                                               buffer, static_cast<uint64_t>(allocation.offset) * pool.elementSize,
+                                               static_cast<uint64_t>(allocation.size) * pool.elementSize);
+                }
+            } else {
+                encoder.copyBufferToBuffer(pool.buffer, 0, buffer, 0, pool.buffer.getSize());
+                pool.allocator.Grow(capacity);
+            }
+
+            wgpu::CommandBufferDescriptor cmdBufferDescriptor{};
+            cmdBufferDescriptor.nextInChain = nullptr;
+#ifdef WR_DEBUG
+            cmdBufferDescriptor.label = "Mesh pool relocation";
+#else
+            cmdBufferDescriptor.label = nullptr;
+#endif
+            wgpu::CommandBuffer cmdBuffer = encoder.finish(cmdBufferDescriptor);
+            encoder.release();
+            m_Queue.submit(1, &cmdBuffer);
+            cmdBuffer.release();
+        } else if (pack) {
+            pool.allocator.Reset(capacity);
+        } else {
+            pool.allocator.Grow(capacity);
+        }
+
+        // The frames in flight keep the previous buffer alive until they complete.
+        if (pool.buffer) {
+            pool.buffer.release();
+        }
+
+        pool.buffer = buffer;
+        return true;
+    }
+
+    OffsetAllocator::Allocation& MeshPool::GetAllocation(Mesh& mesh, const Pool& pool) {
+        return &pool == &m_VertexPool ? mesh.vertices : mesh.indices;
+    }
+}
@@ -0,0 +1,311 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/OffsetAllocator.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace WGPURenderer {
+    float OffsetAllocatorStatistics::GetFragmentation() const {
+        if (freeSize == 0) {
+            return 0.0f;
+        }
+
+        return 1.0f - static_cast<float>(largestFreeRegion) / static_cast<float>(freeSize);
+    }
+
+    float OffsetAllocatorStatistics::GetOccupancy() const {
+        if (capacity == 0) {
+            return 0.0f;
+        }
+
+        return static_cast<float>(usedSize) / static_cast<float>(capacity);
+    }
+
+    void OffsetAllocator::Reset(const uint32_t capacity) {
+        m_Nodes.clear();
+        m_UnusedNodes.clear();
+        m_BinHeads.fill(InvalidNode);
+        m_SecondLevelBitmaps.fill(0);
+        m_FirstLevelBitmap = 0;
+        m_LastNode = InvalidNode;
+        m_Capacity = 0;
+        m_UsedSize = 0;
+        m_AllocationCount = 0;
+        m_FreeRegionCount = 0;
+
+        Grow(capacity);
+    }
+
+    void OffsetAllocator::Grow(const uint32_t capacity) {
+        if (capacity <= m_Capacity) {
+            return;
+        }
+
+        const uint32_t addedSize = capacity - m_Capacity;
+
+        if (m_LastNode != InvalidNode && m_Nodes[m_LastNode].free) {
+            // The free region at the end simply gets larger, which may move it to another bin.
+            RemoveFreeNode(m_LastNode);
+            m_Nodes[m_LastNode].size += addedSize;
+            InsertFreeNode(m_LastNode);
+        } else {
+            const uint32_t node = CreateNode(m_Capacity, addedSize);
+            m_Nodes[node].previous = m_LastNode;
+            if (m_LastNode != InvalidNode) {
+                m_Nodes[m_LastNode].next = node;
+            }
+
+            m_LastNode = node;
+            InsertFreeNode(node);
+        }
+
+        m_Capacity = capacity;
+    }
+
+    bool OffsetAllocator::Allocate(const uint32_t size, Allocation& allocation) {
+        if (size == 0) {
+            return false;
+        }
+
+        uint32_t node = InvalidNode;
+        const uint32_t binIndex = FindFreeBin(GetFittingBinIndex(size));
+        if (binIndex != InvalidNode) {
+            node = m_BinHeads[binIndex];
+        } else {
+            // Some regions of the size's own bin may fit it too, e.g. the whole capacity when it isn't a bin boundary.
+            // They are only searched when no larger bin has any region.
+            const uint32_t sizeBinIndex = GetBinIndex(size);
+            const uint32_t firstLevel = sizeBinIndex / SecondLevelCount;
+            if ((m_SecondLevelBitmaps[firstLevel] & (1u << (sizeBinIndex % SecondLevelCount))) != 0) {
+                for (uint32_t candidate = m_BinHeads[sizeBinIndex]; candidate != InvalidNode;
+                     candidate = m_Nodes[candidate].nextFree) {
+                    if (m_Nodes[candidate].size >= size) {
+                        node = candidate;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (node == InvalidNode) {
+            return false;
+        }
+
+        RemoveFreeNode(node);
+
+        // The rest of the region goes back to the bins.
+        if (m_Nodes[node].size > size) {
+            const uint32_t remainder = CreateNode(m_Nodes[node].offset + size, m_Nodes[node].size - size);
+            const uint32_t next = m_Nodes[node].next;
+
+            m_Nodes[remainder].previous = node;
+            m_Nodes[remainder].next = next;
+            if (next != InvalidNode) {
+                m_Nodes[next].previous = remainder;
+            } else {
+                m_LastNode = remainder;
+            }
+
+            m_Nodes[node].next = remainder;
+            m_Nodes[node].size = size;
+            InsertFreeNode(remainder);
+        }
+
+        m_UsedSize += size;
+        ++m_AllocationCount;
+
+        allocation.offset = m_Nodes[node].offset;
+        allocation.size = size;
+        allocation.node = node;
+        return true;
+    }
+
+    void OffsetAllocator::Free(const Allocation& allocation) {
+        uint32_t node = allocation.node;
+        if (node >= m_Nodes.size() || m_Nodes[node].free) {
+            return;
+        }
+
+        m_UsedSize -= m_Nodes[node].size;
+        --m_AllocationCount;
+
+        // Merges with the free neighbours, so that free regions never touch.
+        const uint32_t previous = m_Nodes[node].previous;
+        if (previous != InvalidNode && m_Nodes[previous].free) {
+            RemoveFreeNode(previous);
+            m_Nodes[previous].size += m_Nodes[node].size;
+            m_Nodes[previous].next = m_Nodes[node].next;
+            if (m_Nodes[node].next != InvalidNode) {
+                m_Nodes[m_Nodes[node].next].previous = previous;
+            } else {
+                m_LastNode = previous;
+            }
+
+            DestroyNode(node);
+            node = previous;
+        }
+
+        const uint32_t next = m_Nodes[node].next;
+        if (next != InvalidNode && m_Nodes[next].free) {
+            RemoveFreeNode(next);
+            m_Nodes[node].size += m_Nodes[next].size;
+            m_Nodes[node].next = m_Nodes[next].next;
+            if (m_Nodes[next].next != InvalidNode) {
+                m_Nodes[m_Nodes[next].next].previous = node;
+            } else {
+                m_LastNode = node;
+            }
+
+            DestroyNode(next);
+        }
+
+        InsertFreeNode(node);
+    }
+
+    uint32_t OffsetAllocator::GetCapacity() const {
+        return m_Capacity;
+    }
+
+    OffsetAllocatorStatistics OffsetAllocator::GetStatistics() const {
+        OffsetAllocatorStatistics statistics;
+        statistics.capacity = m_Capacity;
+        statistics.usedSize = m_UsedSize;
+        statistics.freeSize = m_Capacity - m_UsedSize;
+        statistics.allocationCount = m_AllocationCount;
+        statistics.freeRegionCount = m_FreeRegionCount;
+
+        // The largest region is in the last non-empty bin, which only holds regions of similar sizes.
+        if (m_FirstLevelBitmap != 0) {
+            const uint32_t firstLevel = std::bit_width(m_FirstLevelBitmap) - 1;
+            const uint32_t secondLevel = std::bit_width(static_cast<uint32_t>(m_SecondLevelBitmaps[firstLevel])) - 1;
+            for (uint32_t node = m_BinHeads[firstLevel * SecondLevelCount + secondLevel]; node != InvalidNode;
+                 node = m_Nodes[node].nextFree) {
+                statistics.largestFreeRegion = std::max(statistics.largestFreeRegion, m_Nodes[node].size);
+            }
+        }
+
+        return statistics;
+    }
+
+    uint32_t OffsetAllocator::GetBinIndex(const uint32_t size) {
+        if (size < SecondLevelCount) {
+            return size;
+        }
+
+        const uint32_t firstLevel = std::bit_width(size) - 1;
+        const uint32_t secondLevel = (size >> (firstLevel - SecondLevelBits)) & (SecondLevelCount - 1);
+        return (firstLevel - SecondLevelBits + 1) * SecondLevelCount + secondLevel;
+    }
+
+    uint32_t OffsetAllocator::GetFittingBinIndex(const uint32_t size) {
+        if (size < SecondLevelCount) {
+            return size;
+        }
+
+        // Rounds the size up to the next bin boundary, every region of that bin is then large enough.
+        const uint32_t firstLevel = std::bit_width(size) - 1;
+        const uint64_t roundedSize = static_cast<uint64_t>(size) + (1u << (firstLevel - SecondLevelBits)) - 1;
+        if (roundedSize > std::numeric_limits<uint32_t>::max()) {
+            return FirstLevelCount * SecondLevelCount;
+        }
+
+        return GetBinIndex(static_cast<uint32_t>(roundedSize));
+    }
+
+    uint32_t OffsetAllocator::CreateNode(const uint32_t offset, const uint32_t size) {
+        uint32_t node;
+        if (!m_UnusedNodes.empty()) {
+            node = m_UnusedNodes.back();
+            m_UnusedNodes.pop_back();
+        } else {
+            node = static_cast<uint32_t>(m_Nodes.size());
+            m_Nodes.emplace_back();
+        }
+
+        m_Nodes[node] = Node{};
+        m_Nodes[node].offset = offset;
+        m_Nodes[node].size = size;
+        return node;
+    }
+
+    void OffsetAllocator::DestroyNode(const uint32_t node) {
+        m_Nodes[node] = Node{};
+        m_UnusedNodes.push_back(node);
+    }
+
+    void OffsetAllocator::InsertFreeNode(const uint32_t node) {
+        const uint32_t binIndex = GetBinIndex(m_Nodes[node].size);
+        const uint32_t firstLevel = binIndex / SecondLevelCount;
+        const uint32_t secondLevel = binIndex % SecondLevelCount;
+        const bool binEmpty = (m_SecondLevelBitmaps[firstLevel] & (1u << secondLevel)) == 0;
+        const uint32_t head = binEmpty ? InvalidNode : m_BinHeads[binIndex];
+
+        m_Nodes[node].free = true;
+        m_Nodes[node].previousFree = InvalidNode;
+        m_Nodes[node].nextFree = head;
+        if (head != InvalidNode) {
+            m_Nodes[head].previousFree = node;
+        }
+
+        m_BinHeads[binIndex] = node;
+        m_SecondLevelBitmaps[firstLevel] |= static_cast<uint8_t>(1u << secondLevel);
+        m_FirstLevelBitmap |= 1u << firstLevel;
+        ++m_FreeRegionCount;
+    }
+
+    void OffsetAllocator::RemoveFreeNode(const uint32_t node) {
+        const uint32_t binIndex = GetBinIndex(m_Nodes[node].size);
+        const uint32_t previousFree = m_Nodes[node].previousFree;
+        const uint32_t nextFree = m_Nodes[node].nextFree;
+
+        if (previousFree != InvalidNode) {
+            m_Nodes[previousFree].nextFree = nextFree;
+        } else {
+            m_BinHeads[binIndex] = nextFree;
+        }
+
+        if (nextFree != InvalidNode) {
+            m_Nodes[nextFree].previousFree = previousFree;
+        }
+
+        // Clears the bin's bits once it's empty.
+        if (m_BinHeads[binIndex] == InvalidNode) {
+            const uint32_t firstLevel = binIndex / SecondLevelCount;
+            m_SecondLevelBitmaps[firstLevel] &= static_cast<uint8_t>(~(1u << (binIndex % SecondLevelCount)));
+            if (m_SecondLevelBitmaps[firstLevel] == 0) {
+                m_FirstLevelBitmap &= ~(1u << firstLevel);
+            }
+        }
+
+        m_Nodes[node].free = false;
+        m_Nodes[node].previousFree = InvalidNode;
+        m_Nodes[node].nextFree = InvalidNode;
+        --m_FreeRegionCount;
+    }
+
+    uint32_t OffsetAllocator::FindFreeBin(const uint32_t binIndex) const {
+        const uint32_t firstLevel = binIndex / SecondLevelCount;
+        if (firstLevel >= FirstLevelCount) {
+            return InvalidNode;
+        }
+
+        // A larger bin of the same first level.
+        const uint32_t secondLevelMask = m_SecondLevelBitmaps[firstLevel] & (0xFFu << (binIndex % SecondLevelCount));
+        if (secondLevelMask != 0) {
+            return firstLevel * SecondLevelCount + std::countr_zero(secondLevelMask);
+        }
+
+        // Otherwise the smallest bin of the next non-empty first level.
+        const uint32_t firstLevelMask = firstLevel + 1 < 32 ? m_FirstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+        if (firstLevelMask == 0) {
+            return InvalidNode;
+        }
+
+        const uint32_t nextFirstLevel = std::countr_zero(firstLevelMask);
+        return nextFirstLevel * SecondLevelCount +
+               std::countr_zero(static_cast<uint32_t>(m_SecondLevelBitmaps[nextFirstLevel]));
+    }
+}
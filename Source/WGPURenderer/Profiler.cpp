@@ -0,0 +1,150 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/Profiler.hpp>
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        struct ProfileEvent {
+            const char* name;
+            uint64_t start;
+            uint64_t end;
+        };
+
+        // Events are stored in fixed size blocks, so that recording never moves the previous events.
+        constexpr size_t EventBlockSize = 4096;
+        using EventBlock = std::array<ProfileEvent, EventBlockSize>;
+
+        struct ThreadBuffer {
+            uint32_t threadId = 0;
+            const char* threadName = nullptr;
+            std::vector<std::unique_ptr<EventBlock>> blocks;
+            size_t eventCount = 0;
+        };
+
+        // Owns the buffers of every thread, so that the events of the threads that already exited are written too.
+        struct BufferRegistry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        };
+
+        BufferRegistry& GetRegistry() {
+            static BufferRegistry registry;
+            return registry;
+        }
+
+        thread_local ThreadBuffer* t_Buffer = nullptr;
+
+        // Only the first call of each thread takes the registry's lock.
+        ThreadBuffer& GetThreadBuffer() {
+            if (!t_Buffer) [[unlikely]] {
+                BufferRegistry& registry = GetRegistry();
+                const std::lock_guard lock(registry.mutex);
+
+                t_Buffer = registry.buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+                t_Buffer->threadId = static_cast<uint32_t>(registry.buffers.size());
+            }
+
+            return *t_Buffer;
+        }
+
+        void WriteJsonString(std::ofstream& file, const std::string_view text) {
+            file << '"';
+            for (const char c : text) {
+                if (c == '"' || c == '\\') {
+                    file << '\\' << c;
+                } else if (static_cast<unsigned char>(c) >= 0x20) {
+                    file << c;
+                }
+            }
+            file << '"';
+        }
+    }
+
+    const std::chrono::steady_clock::time_point Profiler::s_Epoch = std::chrono::steady_clock::now();
+
+    void Profiler::RecordScope(const char* name, const uint64_t start, const uint64_t end) {
+        ThreadBuffer& buffer = GetThreadBuffer();
+
+        const size_t blockIndex = buffer.eventCount / EventBlockSize;
+        if (blockIndex == buffer.blocks.size()) [[unlikely]] {
+            buffer.blocks.push_back(std::make_unique_for_overwrite<EventBlock>());
+        }
+
+        (*buffer.blocks[blockIndex])[buffer.eventCount % EventBlockSize] = {name, start, end};
+        ++buffer.eventCount;
+    }
+
+    void Profiler::SetThreadName(const char* name) {
+        GetThreadBuffer().threadName = name;
+    }
+
+    bool Profiler::WriteChromeTrace(const std::filesystem::path& path) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        BufferRegistry& registry = GetRegistry();
+        const std::lock_guard lock(registry.mutex);
+
+        // Complete events, with their timestamps and durations in microseconds.
+        file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+
+        bool first = true;
+        const auto beginEvent = [&file, &first] {
+            file << (first ? "  " : ",\n  ");
+            first = false;
+        };
+
+        for (const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers) {
+            if (buffer->threadName) {
+                beginEvent();
+                file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->threadId
+                     << ", \"args\": {\"name\": ";
+                WriteJsonString(file, buffer->threadName);
+                file << "}}";
+            }
+
+            for (size_t i = 0; i < buffer->eventCount; ++i) {
+                const ProfileEvent& event = (*buffer->blocks[i / EventBlockSize])[i % EventBlockSize];
+
+                beginEvent();
+                file << "{\"name\": ";
+                WriteJsonString(file, event.name);
+                file << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->threadId
+                     << ", \"ts\": " << static_cast<double>(event.start) / 1000.0
+                     << ", \"dur\": " << static_cast<double>(event.end - event.start) / 1000.0 << '}';
+            }
+        }
+
+        file << "\n]}\n";
+
+        file.close();
+        return !file.fail();
+    }
+
+    double Profiler::MeasureScopeOverhead(const size_t scopeCount) {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        const size_t eventCount = buffer.eventCount;
+
+        const uint64_t start = GetTimestamp();
+        for (size_t i = 0; i < scopeCount; ++i) {
+            const ProfileScope scope("Profiler overhead");
+        }
+        const uint64_t end = GetTimestamp();
+
+        buffer.eventCount = eventCount;
+
+        return scopeCount != 0 ? static_cast<double>(end - start) / static_cast<double>(scopeCount) : 0.0;
+    }
+}
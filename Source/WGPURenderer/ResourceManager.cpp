@@ -3,78 +3,457 @@
 // For conditions of distribution and use, see copyright notice in LICENSE.
 
 #include <WGPURenderer/ResourceManager.hpp>
+#include <WGPURenderer/FrameArena.hpp>
+#include <WGPURenderer/GeometryCache.hpp>
+#include <WGPURenderer/JobSystem.hpp>
+#include <WGPURenderer/MappedFile.hpp>
+#include <WGPURenderer/MeshOptimizer.hpp>
+#include <WGPURenderer/Profiler.hpp>
+#include <WGPURenderer/VertexQuantizer.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <iostream>
+#include <memory_resource>
+#include <numeric>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace WGPURenderer {
-    bool ResourceManager::LoadGeometry(const std::filesystem::path& path,
-                                       std::vector<float>& pointData,
-                                       std::vector<uint16_t>& indexData) {
-        std::ifstream file(std::filesystem::path("Resources/Models") / path);
-        if (!file.is_open()) {
-            return false;
-        }
-
-        pointData.clear();
-        indexData.clear();
-
+    namespace {
         enum class Section : uint8_t {
             None,
+            Layout,
             Points,
             Indices,
+            Unknown, // Not known yet while counting a chunk, until its first section header.
+        };
+
+        constexpr size_t IndexComponentCount = 3; // corners #0 #1 and #2
+
+        // Below this, spawning workers costs more than what they save.
+        constexpr size_t MinParseChunkSize = 1024 * 1024;
+
+        struct ParseChunk {
+            std::string_view text;
+            Section entrySection = Section::None;
+            Section exitSection = Section::Unknown;
+            size_t leadingLineCount = 0; // Data lines preceding the first section header of the chunk.
+            size_t pointLineCount = 0;
+            size_t indexLineCount = 0;
+            size_t pointLineOffset = 0;
+            size_t indexLineOffset = 0;
+            bool success = false;
         };
-        auto currentSection = Section::None;
 
-        float value;
-        uint16_t index;
-        std::string line;
-        while (!file.eof()) {
-            getline(file, line);
+        bool IsBlank(const char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        std::string_view TrimLine(std::string_view line) {
+            // Trailing '\r' is stripped here as well, which overcomes the `CRLF` problem.
+            while (!line.empty() && IsBlank(line.front())) {
+                line.remove_prefix(1);
+            }
+
+            while (!line.empty() && IsBlank(line.back())) {
+                line.remove_suffix(1);
+            }
+
+            return line;
+        }
+
+        // Calls `func(section, line)` for every line holding data, skipping section headers, blank lines and comments.
+        // Stops and returns false as soon as `func` does.
+        template<typename Func>
+        bool ForEachDataLine(const std::string_view text, Section& section, Func&& func) {
+            size_t cursor = 0;
+            while (cursor < text.size()) {
+                size_t end = text.find('\n', cursor);
+                if (end == std::string_view::npos) {
+                    end = text.size();
+                }
+
+                const std::string_view line = TrimLine(text.substr(cursor, end - cursor));
+                cursor = end + 1;
+
+                if (line == "[layout]") {
+                    section = Section::Layout;
+                } else if (line == "[points]") {
+                    section = Section::Points;
+                } else if (line == "[indices]") {
+                    section = Section::Indices;
+                } else if (line.empty() || line.front() == '#') {
+                    // Do nothing, this is a comment
+                } else if (!func(section, line)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        template<typename T>
+        bool ParseValues(const std::string_view line, T* out, const size_t count) {
+            const char* first = line.data();
+            const char* const last = first + line.size();
+
+            for (size_t i = 0; i < count; ++i) {
+                while (first != last && IsBlank(*first)) {
+                    ++first;
+                }
+
+                // std::from_chars doesn't accept an explicit plus sign, unlike the stream operators did.
+                if (first != last && *first == '+') {
+                    ++first;
+                }
+
+                const auto [ptr, ec] = std::from_chars(first, last, out[i]);
+                if (ec != std::errc{}) {
+                    return false;
+                }
+
+                first = ptr;
+            }
+
+            return true;
+        }
+
+        // The optional [layout] section lists one `<semantic> <component count>` per line and must come before the
+        // data. Models without one use the default x, y, r, g, b layout.
+        bool ParseLayout(const std::string_view content, VertexLayout& layout) {
+            layout = VertexLayout{};
+
+            bool valid = true;
+            auto section = Section::None;
+            ForEachDataLine(content, section, [&](const Section lineSection, const std::string_view line) {
+                // Stop at the first line that isn't part of the layout.
+                if (lineSection != Section::Layout) {
+                    return false;
+                }
+
+                const size_t separator = line.find_first_of(" \t");
+                VertexSemantic semantic;
+                uint32_t componentCount;
+                if (separator == std::string_view::npos ||
+                    !VertexLayout::ParseSemantic(line.substr(0, separator), semantic) ||
+                    !ParseValues(line.substr(separator), &componentCount, 1) ||
+                    !layout.AddAttribute(semantic, componentCount)) {
+                    valid = false;
+                    return false;
+                }
+
+                return true;
+            });
+
+            if (layout.GetAttributes().empty()) {
+                layout = VertexLayout::GetDefault();
+            }
+
+            return valid;
+        }
+
+        std::vector<ParseChunk> SplitIntoChunks(const std::string_view content, unsigned int threadCount) {
+            if (threadCount == 0) {
+                threadCount = JobSystem::GetThreadCount();
+            }
+
+            const size_t chunkCount = std::clamp<size_t>(content.size() / MinParseChunkSize, 1, threadCount);
+            const size_t chunkSize = content.size() / chunkCount;
+
+            // Chunks always end right after a line feed, so that no line is split between two of them.
+            std::vector<ParseChunk> chunks;
+            chunks.reserve(chunkCount);
+
+            size_t begin = 0;
+            for (size_t i = 1; i <= chunkCount && begin < content.size(); ++i) {
+                size_t end = content.size();
+                if (i < chunkCount) {
+                    end = content.find('\n', std::max(begin, i * chunkSize));
+                    end = end == std::string_view::npos ? content.size() : end + 1;
+                }
+
+                chunks.emplace_back().text = content.substr(begin, end - begin);
+                begin = end;
+            }
+
+            return chunks;
+        }
+
+        // Runs `func(chunk)` for every chunk, in parallel on the job system.
+        template<typename Func>
+        void ForEachChunk(std::vector<ParseChunk>& chunks, Func&& func) {
+            const auto runChunks = [&](const uint32_t begin, const uint32_t end) {
+                for (uint32_t i = begin; i < end; ++i) {
+                    func(chunks[i]);
+                }
+            };
+
+            JobSystem::ParallelFor(static_cast<uint32_t>(chunks.size()), 1, runChunks);
+        }
+
+        // Second pass over a chunk. `StaticComponentCount` is the number of components of a point when known at
+        // compile time, which gives the common layouts an unrolled kernel, and 0 for the generic one.
+        template<size_t StaticComponentCount>
+        bool ParseChunkValues(const ParseChunk& chunk, float* pointData, uint32_t* indexData,
+                              const size_t dynamicComponentCount) {
+            const size_t componentCount = StaticComponentCount != 0 ? StaticComponentCount : dynamicComponentCount;
+
+            float* points = pointData + chunk.pointLineOffset * componentCount;
+            uint32_t* indices = indexData + chunk.indexLineOffset * IndexComponentCount;
+            auto section = chunk.entrySection;
+            return ForEachDataLine(chunk.text, section, [&](const Section lineSection, const std::string_view line) {
+                if (lineSection == Section::Points) {
+                    if (!ParseValues(line, points, componentCount)) {
+                        return false;
+                    }
+                    points += componentCount;
+                } else if (lineSection == Section::Indices) {
+                    if (!ParseValues(line, indices, IndexComponentCount)) {
+                        return false;
+                    }
+                    indices += IndexComponentCount;
+                }
+
+                return true;
+            });
+        }
+
+        using ParseKernel = bool (*)(const ParseChunk&, float*, uint32_t*, size_t);
+
+        ParseKernel SelectParseKernel(const size_t componentCount) {
+            switch (componentCount) {
+                case 5: // position 2, color 3
+                    return &ParseChunkValues<5>;
+                case 6: // position 3, color 3
+                    return &ParseChunkValues<6>;
+                case 8: // position 3, normal 3, texcoord 2
+                    return &ParseChunkValues<8>;
+                case 9: // position 3, normal 3, color 3
+                    return &ParseChunkValues<9>;
+                default:
+                    return &ParseChunkValues<0>;
+            }
+        }
+
+        bool ParseGeometry(const std::string_view content,
+                           VertexLayout& layout,
+                           std::vector<float>& pointData,
+                           std::vector<uint32_t>& indexData,
+                           const unsigned int threadCount) {
+            WR_PROFILE_SCOPE("ParseGeometry");
 
-            // overcome the `CRLF` problem
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
+            pointData.clear();
+            indexData.clear();
+
+            if (!ParseLayout(content, layout)) {
+                return false;
             }
 
-            if (line == "[points]") {
-                currentSection = Section::Points;
-            } else if (line == "[indices]") {
-                currentSection = Section::Indices;
-            } else if (line[0] == '#' || line.empty()) {
-                // Do nothing, this is a comment
-            } else if (currentSection == Section::Points) {
-                std::istringstream iss(line);
-                // Get x, y, r, g, b
-                for (int i = 0; i < 5; ++i) {
-                    iss >> value;
-                    pointData.push_back(value);
+            const size_t componentCount = layout.GetComponentCount();
+
+            std::vector<ParseChunk> chunks = SplitIntoChunks(content, threadCount);
+
+            // First pass: count the lines of each section in every chunk. The section of the lines preceding the
+            // first header of a chunk is only known once the previous chunks have been counted.
+            ForEachChunk(chunks, [](ParseChunk& chunk) {
+                WR_PROFILE_SCOPE("Count chunk lines");
+                auto section = Section::Unknown;
+                ForEachDataLine(chunk.text, section, [&chunk](const Section lineSection, std::string_view) {
+                    chunk.leadingLineCount += lineSection == Section::Unknown ? 1 : 0;
+                    chunk.pointLineCount += lineSection == Section::Points ? 1 : 0;
+                    chunk.indexLineCount += lineSection == Section::Indices ? 1 : 0;
+                    return true;
+                });
+                chunk.exitSection = section;
+            });
+
+            // Resolve the entry section of each chunk and turn the counts into output offsets.
+            auto currentSection = Section::None;
+            size_t pointLineCount = 0;
+            size_t indexLineCount = 0;
+            for (ParseChunk& chunk : chunks) {
+                chunk.entrySection = currentSection;
+                if (currentSection == Section::Points) {
+                    chunk.pointLineCount += chunk.leadingLineCount;
+                } else if (currentSection == Section::Indices) {
+                    chunk.indexLineCount += chunk.leadingLineCount;
                 }
-            } else if (currentSection == Section::Indices) {
-                std::istringstream iss(line);
-                // Get corners #0 #1 and #2
-                for (int i = 0; i < 3; ++i) {
-                    iss >> index;
-                    indexData.push_back(index);
+
+                chunk.pointLineOffset = pointLineCount;
+                chunk.indexLineOffset = indexLineCount;
+                pointLineCount += chunk.pointLineCount;
+                indexLineCount += chunk.indexLineCount;
+
+                if (chunk.exitSection != Section::Unknown) {
+                    currentSection = chunk.exitSection;
+                }
+            }
+
+            pointData.resize(pointLineCount * componentCount);
+            indexData.resize(indexLineCount * IndexComponentCount);
+
+            // Second pass: parse the values in place, each chunk writing its own slice of the outputs.
+            const ParseKernel parseKernel = SelectParseKernel(componentCount);
+            ForEachChunk(chunks, [&](ParseChunk& chunk) {
+                WR_PROFILE_SCOPE("Parse chunk");
+                chunk.success = parseKernel(chunk, pointData.data(), indexData.data(), componentCount);
+            });
+
+            const bool success = std::ranges::all_of(chunks, [](const ParseChunk& chunk) { return chunk.success; });
+            if (!success) {
+                pointData.clear();
+                indexData.clear();
+                return false;
+            }
+
+            return true;
+        }
+
+        // Welds the mesh, reorders it for the vertex cache then for the vertex fetch, and reports how the cache
+        // behaves. Meshes without indices are considered as plain triangle lists and get them generated.
+        void OptimizeGeometry(const std::filesystem::path& path,
+                              const VertexLayout& layout,
+                              std::vector<float>& pointData,
+                              std::vector<uint32_t>& indexData) {
+            WR_PROFILE_SCOPE("OptimizeGeometry");
+
+            const size_t componentCount = layout.GetComponentCount();
+            size_t vertexCount = pointData.size() / componentCount;
+            if (indexData.empty()) {
+                // A triangle list, whose trailing vertices can't form a whole triangle.
+                if (const size_t extraVertexCount = vertexCount % IndexComponentCount; extraVertexCount != 0) {
+                    std::cerr << "Geometry " << path << " has no indices and " << vertexCount
+                              << " vertices, which isn't a multiple of 3, the last " << extraVertexCount
+                              << " are dropped!\n";
+                    vertexCount -= extraVertexCount;
+                    pointData.resize(vertexCount * componentCount);
                 }
+
+                indexData.resize(vertexCount);
+                std::iota(indexData.begin(), indexData.end(), 0u);
+            }
+
+            if (std::ranges::any_of(indexData, [vertexCount](const uint32_t index) { return index >= vertexCount; })) {
+                std::cerr << "Geometry " << path << " references out of range vertices, it won't be optimized!\n";
+                return;
             }
+
+            const size_t uniqueVertexCount = MeshOptimizer::WeldVertices(indexData, pointData, componentCount);
+
+            const VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(indexData, uniqueVertexCount);
+
+            MeshOptimizer::OptimizeVertexCache(indexData, uniqueVertexCount);
+            const size_t usedVertexCount = MeshOptimizer::OptimizeVertexFetch(indexData, pointData, componentCount);
+
+            const VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(indexData, usedVertexCount);
+
+            std::cout << "Optimized geometry " << path << ": " << vertexCount << " -> " << usedVertexCount
+                      << " vertices, ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr
+                      << " -> " << after.atvr << '\n';
         }
+
+        void EncodeVertices(const std::filesystem::path& path,
+                            const VertexLayout& layout,
+                            const std::vector<float>& pointData,
+                            const VertexEncoding encoding,
+                            Geometry& geometry) {
+            if (encoding == VertexEncoding::Quantized) {
+                PositionTransform transform;
+                QuantizationReport report;
+                geometry.SetVertices(VertexQuantizer::Quantize(pointData, layout, transform, report), layout, encoding);
+                geometry.SetPositionTransform(transform);
+
+                std::cout << "Quantized geometry " << path << ": max position error " << report.maxPositionError
+                          << ", max color error " << report.maxColorError << ", max normal error "
+                          << report.maxNormalError << ", max texcoord error " << report.maxTexCoordError << '\n';
+            } else {
+                std::vector<std::byte> vertexData(pointData.size() * sizeof(float));
+                std::memcpy(vertexData.data(), pointData.data(), vertexData.size());
+                geometry.SetVertices(std::move(vertexData), layout, encoding);
+                geometry.SetPositionTransform({});
+            }
+        }
+
+        std::string_view AsText(const MappedFile& file) {
+            const std::span<const std::byte> data = file.GetData();
+            return {reinterpret_cast<const char*>(data.data()), data.size()};
+        }
+    }
+
+    bool ResourceManager::LoadGeometry(const std::filesystem::path& path,
+                                       VertexLayout& layout,
+                                       std::vector<float>& pointData,
+                                       std::vector<uint32_t>& indexData,
+                                       const unsigned int threadCount) {
+        WR_PROFILE_SCOPE("ResourceManager::LoadGeometry");
+
+        MappedFile file;
+        if (!file.Open(std::filesystem::path("Resources/Models") / path)) {
+            return false;
+        }
+
+        return ParseGeometry(AsText(file), layout, pointData, indexData, threadCount);
+    }
+
+    bool ResourceManager::LoadGeometry(const std::filesystem::path& path, Geometry& geometry,
+                                       const VertexEncoding vertexEncoding) {
+        WR_PROFILE_SCOPE("ResourceManager::LoadGeometry");
+
+        const std::filesystem::path sourcePath = std::filesystem::path("Resources/Models") / path;
+        if (GeometryCache::Load(sourcePath, vertexEncoding, geometry)) {
+            return true;
+        }
+
+        // Stamped before the source is read, so that an edit made while it is parsed doesn't go unnoticed.
+        GeometryCache::SourceStamp sourceStamp;
+        MappedFile file;
+        if (!GeometryCache::GetSourceStamp(sourcePath, sourceStamp) || !file.Open(sourcePath)) {
+            return false;
+        }
+
+        VertexLayout layout;
+        std::vector<float> pointData;
+        std::vector<uint32_t> indexData;
+        if (!ParseGeometry(AsText(file), layout, pointData, indexData, 0)) {
+            return false;
+        }
+
+        // Optimizing before storing the cache means that the cost is only paid once.
+        OptimizeGeometry(path, layout, pointData, indexData);
+
+        EncodeVertices(path, layout, pointData, vertexEncoding, geometry);
+        geometry.SetIndices(std::move(indexData));
+
+        // A missing cache only costs a reparse on the next run, so this isn't an error.
+        if (!GeometryCache::Store(sourcePath, sourceStamp, AsText(file), geometry)) {
+            std::cerr << "Couldn't write geometry cache for " << sourcePath << "!\n";
+        }
+
         return true;
     }
 
     wgpu::ShaderModule ResourceManager::LoadShaderModule(const std::filesystem::path& path,
                                                          wgpu::Device device) {
+        WR_PROFILE_SCOPE("ResourceManager::LoadShaderModule");
+
         std::ifstream file(std::filesystem::path("Resources/Shaders") / path);
         if (!file.is_open()) {
             return nullptr;
         }
 
+        // The source is only needed until the module is created.
+        FrameArena& arena = FrameArena::GetThreadArena();
+        const FrameArena::Scope arenaScope(arena);
+
         file.seekg(0, std::ios::end);
         size_t size = file.tellg();
-        std::string shaderSource(size, ' ');
+        std::pmr::string shaderSource(size, ' ', &arena);
         file.seekg(0);
         file.read(shaderSource.data(), static_cast<std::streamsize>(size));
 
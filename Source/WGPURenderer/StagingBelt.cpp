@@ -0,0 +1,203 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/StagingBelt.hpp>
+#include <WGPURenderer/Profiler.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace WGPURenderer {
+    namespace {
+        // Copies must be aligned on 4 bytes, and mappings on 8.
+        constexpr uint64_t UploadAlignment = 8;
+
+        uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    void StagingBelt::Initialize(wgpu::Device device, const uint64_t chunkSize, const uint64_t frameBudget) {
+        m_Device = device;
+        m_ChunkSize = AlignUp(std::max<uint64_t>(chunkSize, UploadAlignment), UploadAlignment);
+        m_FrameBudget = frameBudget;
+    }
+
+    void StagingBelt::Terminate() {
+        // Destroying a buffer that is being mapped cancels the mapping, so the chunks that its callback refers to
+        // are kept alive along with the belt rather than reset here.
+        for (const std::unique_ptr<Chunk>& chunk : m_Chunks) {
+            if (chunk->buffer) {
+                chunk->buffer.destroy();
+                chunk->buffer.release();
+                chunk->buffer = nullptr;
+            }
+
+            chunk->mappedData = nullptr;
+        }
+
+        for (Copy& copy : m_Copies) {
+            copy.destination.release();
+        }
+
+        m_Copies.clear();
+    }
+
+    void* StagingBelt::Upload(wgpu::Buffer destination, const uint64_t destinationOffset, const uint64_t size) {
+        if (size == 0 || (m_FrameBudget != 0 && m_FrameUploadSize + size > m_FrameBudget)) {
+            return nullptr;
+        }
+
+        Chunk* chunk = AcquireChunk(size);
+        if (!chunk) {
+            return nullptr;
+        }
+
+        const uint64_t sourceOffset = chunk->usedSize;
+        chunk->usedSize = AlignUp(sourceOffset + size, UploadAlignment);
+        m_FrameUploadSize += size;
+
+        // Uploads that follow each other in both buffers are merged into a single copy.
+        if (!m_Copies.empty()) {
+            Copy& previous = m_Copies.back();
+            const bool sourceFollows = previous.source == chunk->buffer &&
+                                       previous.sourceOffset + previous.size == sourceOffset;
+            const bool destinationFollows = previous.destination == destination &&
+                                            previous.destinationOffset + previous.size == destinationOffset;
+            if (sourceFollows && destinationFollows) {
+                previous.size += size;
+                return chunk->mappedData + sourceOffset;
+            }
+        }
+
+        Copy copy;
+        copy.source = chunk->buffer;
+        copy.sourceOffset = sourceOffset;
+        copy.destination = destination;
+        copy.destinationOffset = destinationOffset;
+        copy.size = size;
+        m_Copies.push_back(copy);
+
+        // The destination may be replaced before Finish(), the copy then lands in the previous buffer harmlessly.
+        destination.reference();
+
+        return chunk->mappedData + sourceOffset;
+    }
+
+    void StagingBelt::Finish(wgpu::CommandEncoder encoder) {
+        WR_PROFILE_SCOPE("StagingBelt::Finish");
+
+        for (const std::unique_ptr<Chunk>& chunk : m_Chunks) {
+            if (chunk->state == ChunkState::Recording) {
+                chunk->buffer.unmap();
+                chunk->mappedData = nullptr;
+                chunk->state = ChunkState::Submitted;
+            }
+        }
+
+        for (Copy& copy : m_Copies) {
+            encoder.copyBufferToBuffer(copy.source, copy.sourceOffset, copy.destination, copy.destinationOffset,
+                                       copy.size);
+            copy.destination.release();
+        }
+
+        m_Copies.clear();
+        m_FrameUploadSize = 0;
+    }
+
+    void StagingBelt::Recall() {
+        // The mapping completes once the GPU is done with the buffer, that is once the copies were executed.
+        for (const std::unique_ptr<Chunk>& chunk : m_Chunks) {
+            if (chunk->state != ChunkState::Submitted) {
+                continue;
+            }
+
+            // The C entry point takes the chunk as is, where the wrapper would allocate a std::function per chunk.
+            chunk->state = ChunkState::Mapping;
+            wgpuBufferMapAsync(chunk->buffer, wgpu::MapMode::Write, 0, chunk->size, &StagingBelt::OnChunkMapped,
+                               chunk.get());
+        }
+    }
+
+    uint64_t StagingBelt::GetFrameUploadSize() const {
+        return m_FrameUploadSize;
+    }
+
+    uint64_t StagingBelt::GetRemainingBudget() const {
+        if (m_FrameBudget == 0) {
+            return std::numeric_limits<uint64_t>::max();
+        }
+
+        return m_FrameBudget - m_FrameUploadSize;
+    }
+
+    size_t StagingBelt::GetChunkCount() const {
+        return m_Chunks.size();
+    }
+
+    void StagingBelt::OnChunkMapped(const WGPUBufferMapAsyncStatus status, void* userdata) {
+        Chunk& chunk = *static_cast<Chunk*>(userdata);
+        chunk.state = status == WGPUBufferMapAsyncStatus_Success ? ChunkState::Mapped : ChunkState::MapFailed;
+    }
+
+    StagingBelt::Chunk* StagingBelt::AcquireChunk(const uint64_t size) {
+        // Chunks that couldn't be mapped again are dropped, new ones replace them.
+        std::erase_if(m_Chunks, [](const std::unique_ptr<Chunk>& chunk) {
+            if (chunk->state != ChunkState::MapFailed) {
+                return false;
+            }
+
+            chunk->buffer.destroy();
+            chunk->buffer.release();
+            return true;
+        });
+
+        for (const std::unique_ptr<Chunk>& chunk : m_Chunks) {
+            if (chunk->state == ChunkState::Recording && chunk->size - chunk->usedSize >= size) {
+                return chunk.get();
+            }
+        }
+
+        for (const std::unique_ptr<Chunk>& chunk : m_Chunks) {
+            if (chunk->state == ChunkState::Mapped && chunk->size >= size) {
+                chunk->mappedData = static_cast<std::byte*>(chunk->buffer.getMappedRange(0, chunk->size));
+                chunk->usedSize = 0;
+                chunk->state = ChunkState::Recording;
+                return chunk.get();
+            }
+        }
+
+        return CreateChunk(size);
+    }
+
+    StagingBelt::Chunk* StagingBelt::CreateChunk(const uint64_t size) {
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        bufferDesc.label = "Staging belt chunk";
+#else
+        bufferDesc.label = nullptr;
+#endif
+        // Larger uploads get a chunk of their own, which is then reused like the others.
+        bufferDesc.size = std::max(m_ChunkSize, AlignUp(size, UploadAlignment));
+        bufferDesc.usage = wgpu::BufferUsage::MapWrite | wgpu::BufferUsage::CopySrc;
+        bufferDesc.mappedAtCreation = true;
+        wgpu::Buffer buffer = m_Device.createBuffer(bufferDesc);
+
+        if (!buffer) {
+            return nullptr;
+        }
+
+        auto chunk = std::make_unique<Chunk>();
+        chunk->buffer = buffer;
+        chunk->size = bufferDesc.size;
+        chunk->mappedData = static_cast<std::byte*>(buffer.getMappedRange(0, chunk->size));
+        chunk->usedSize = 0;
+        chunk->state = ChunkState::Recording;
+
+        m_Chunks.push_back(std::move(chunk));
+        return m_Chunks.back().get();
+    }
+}
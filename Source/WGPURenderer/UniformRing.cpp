@@ -0,0 +1,87 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/UniformRing.hpp>
+
+#include <cstring>
+
+namespace WGPURenderer {
+    namespace {
+        uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    bool UniformRing::Initialize(wgpu::Device device, const uint32_t frameCount, const uint64_t frameSize) {
+        wgpu::SupportedLimits supportedLimits{};
+        if (device.getLimits(&supportedLimits) && supportedLimits.limits.minUniformBufferOffsetAlignment != 0) {
+            m_Alignment = supportedLimits.limits.minUniformBufferOffsetAlignment;
+        }
+
+        m_FrameSize = AlignUp(frameSize, m_Alignment);
+        m_Staging.resize(m_FrameSize);
+
+        wgpu::BufferDescriptor bufferDesc{};
+        bufferDesc.nextInChain = nullptr;
+#ifdef WR_DEBUG
+        bufferDesc.label = "Uniform ring";
+#else
+        bufferDesc.label = nullptr;
+#endif
+        bufferDesc.size = m_FrameSize * frameCount;
+        bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Uniform;
+        bufferDesc.mappedAtCreation = false;
+        m_Buffer = device.createBuffer(bufferDesc);
+
+        return m_Buffer;
+    }
+
+    void UniformRing::Terminate() {
+        if (m_Buffer) {
+            m_Buffer.destroy();
+            m_Buffer.release();
+            m_Buffer = nullptr;
+        }
+    }
+
+    void UniformRing::BeginFrame(const uint32_t frameSlot) {
+        m_FrameOffset = frameSlot * m_FrameSize;
+        m_UsedSize = 0;
+    }
+
+    bool UniformRing::Allocate(const void* data, const uint32_t size, uint32_t& dynamicOffset) {
+        const uint64_t offset = AlignUp(m_UsedSize, m_Alignment);
+        if (offset + size > m_FrameSize) {
+            return false;
+        }
+
+        std::memcpy(m_Staging.data() + offset, data, size);
+        m_UsedSize = offset + size;
+
+        // Dynamic offsets are relative to the start of the binding, which is the start of the buffer.
+        dynamicOffset = static_cast<uint32_t>(m_FrameOffset + offset);
+        return true;
+    }
+
+    void UniformRing::EndFrame(wgpu::Queue queue) {
+        if (m_UsedSize == 0) {
+            return;
+        }
+
+        // writeBuffer sizes must be multiples of 4, the region is aligned so the padding always fits.
+        queue.writeBuffer(m_Buffer, m_FrameOffset, m_Staging.data(), AlignUp(m_UsedSize, 4));
+    }
+
+    wgpu::Buffer UniformRing::GetBuffer() const {
+        return m_Buffer;
+    }
+
+    uint32_t UniformRing::GetAlignment() const {
+        return m_Alignment;
+    }
+
+    uint64_t UniformRing::GetUsedSize() const {
+        return m_UsedSize;
+    }
+}
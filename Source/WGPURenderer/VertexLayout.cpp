@@ -0,0 +1,143 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/VertexLayout.hpp>
+
+#include <algorithm>
+
+namespace WGPURenderer {
+    bool VertexLayout::AddAttribute(const VertexSemantic semantic, const uint32_t componentCount) {
+        if (m_AttributeCount == MaxAttributeCount || HasAttribute(semantic)) {
+            return false;
+        }
+
+        bool validCount = false;
+        switch (semantic) {
+            case VertexSemantic::Position:
+                validCount = componentCount == 2 || componentCount == 3;
+                break;
+            case VertexSemantic::Color:
+                validCount = componentCount == 3 || componentCount == 4;
+                break;
+            case VertexSemantic::Normal:
+                validCount = componentCount == 3;
+                break;
+            case VertexSemantic::TexCoord:
+                validCount = componentCount == 2;
+                break;
+        }
+
+        if (!validCount) {
+            return false;
+        }
+
+        m_Attributes[m_AttributeCount++] = {semantic, componentCount};
+        return true;
+    }
+
+    std::span<const VertexLayoutAttribute> VertexLayout::GetAttributes() const {
+        return std::span<const VertexLayoutAttribute>(m_Attributes).first(m_AttributeCount);
+    }
+
+    bool VertexLayout::HasAttribute(const VertexSemantic semantic) const {
+        return std::ranges::any_of(GetAttributes(), [semantic](const VertexLayoutAttribute& attribute) {
+            return attribute.semantic == semantic;
+        });
+    }
+
+    uint32_t VertexLayout::GetComponentCount() const {
+        uint32_t componentCount = 0;
+        for (const VertexLayoutAttribute& attribute : GetAttributes()) {
+            componentCount += attribute.componentCount;
+        }
+
+        return componentCount;
+    }
+
+    uint32_t VertexLayout::GetStride(const VertexEncoding encoding) const {
+        uint32_t stride = 0;
+        for (const VertexLayoutAttribute& attribute : GetAttributes()) {
+            stride += GetEncodedSize(attribute, encoding);
+        }
+
+        return stride;
+    }
+
+    size_t VertexLayout::BuildVertexAttributes(const VertexEncoding encoding,
+                                               std::array<wgpu::VertexAttribute, MaxAttributeCount>& attributes) const {
+        uint64_t offset = 0;
+        for (uint32_t i = 0; i < m_AttributeCount; ++i) {
+            attributes[i].shaderLocation = static_cast<uint32_t>(m_Attributes[i].semantic);
+            attributes[i].format = GetVertexFormat(m_Attributes[i], encoding);
+            attributes[i].offset = offset;
+
+            offset += GetEncodedSize(m_Attributes[i], encoding);
+        }
+
+        return m_AttributeCount;
+    }
+
+    VertexLayout VertexLayout::GetDefault() {
+        VertexLayout layout;
+        layout.AddAttribute(VertexSemantic::Position, 2);
+        layout.AddAttribute(VertexSemantic::Color, 3);
+        return layout;
+    }
+
+    bool VertexLayout::ParseSemantic(const std::string_view name, VertexSemantic& semantic) {
+        if (name == "position") {
+            semantic = VertexSemantic::Position;
+        } else if (name == "color") {
+            semantic = VertexSemantic::Color;
+        } else if (name == "normal") {
+            semantic = VertexSemantic::Normal;
+        } else if (name == "texcoord") {
+            semantic = VertexSemantic::TexCoord;
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    wgpu::VertexFormat VertexLayout::GetVertexFormat(const VertexLayoutAttribute& attribute,
+                                                     const VertexEncoding encoding) {
+        if (encoding == VertexEncoding::Float) {
+            switch (attribute.componentCount) {
+                case 2:
+                    return wgpu::VertexFormat::Float32x2;
+                case 3:
+                    return wgpu::VertexFormat::Float32x3;
+                default:
+                    return wgpu::VertexFormat::Float32x4;
+            }
+        }
+
+        // There are no 3-component formats below 32 bits, those get a padding component.
+        switch (attribute.semantic) {
+            case VertexSemantic::Position:
+                return attribute.componentCount == 2 ? wgpu::VertexFormat::Snorm16x2 : wgpu::VertexFormat::Snorm16x4;
+            case VertexSemantic::Color:
+                return wgpu::VertexFormat::Unorm8x4;
+            case VertexSemantic::Normal:
+                return wgpu::VertexFormat::Snorm8x4;
+            case VertexSemantic::TexCoord:
+                return wgpu::VertexFormat::Float16x2;
+        }
+
+        return wgpu::VertexFormat::Undefined;
+    }
+
+    uint32_t VertexLayout::GetEncodedSize(const VertexLayoutAttribute& attribute, const VertexEncoding encoding) {
+        if (encoding == VertexEncoding::Float) {
+            return attribute.componentCount * static_cast<uint32_t>(sizeof(float));
+        }
+
+        if (attribute.semantic == VertexSemantic::Position) {
+            return attribute.componentCount == 2 ? 4 : 8;
+        }
+
+        return 4;
+    }
+}
@@ -0,0 +1,201 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#include <WGPURenderer/VertexQuantizer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace WGPURenderer {
+    namespace {
+        int16_t EncodeSnorm16(const float value) {
+            return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+        }
+
+        float DecodeSnorm16(const int16_t value) {
+            // Same rule as the GPU: -32768 and -32767 both map to -1.
+            return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+        }
+
+        int8_t EncodeSnorm8(const float value) {
+            return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+        }
+
+        float DecodeSnorm8(const int8_t value) {
+            return std::max(static_cast<float>(value) / 127.0f, -1.0f);
+        }
+
+        uint8_t EncodeUnorm8(const float value) {
+            return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+
+        float DecodeUnorm8(const uint8_t value) {
+            return static_cast<float>(value) / 255.0f;
+        }
+
+        // Rounds to nearest, ties away from zero. Out of range values become infinities.
+        uint16_t EncodeFloat16(const float value) {
+            const auto bits = std::bit_cast<uint32_t>(value);
+            const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+            const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+            uint32_t mantissa = bits & 0x7FFFFF;
+
+            if ((bits & 0x7FFFFFFF) >= 0x7F800000) {
+                return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+            }
+
+            if (exponent >= 31) {
+                return static_cast<uint16_t>(sign | 0x7C00);
+            }
+
+            if (exponent <= 0) {
+                if (exponent < -10) {
+                    return sign;
+                }
+
+                // Subnormal half: the implicit bit becomes explicit.
+                mantissa |= 0x800000;
+                const auto shift = static_cast<uint32_t>(14 - exponent);
+                uint32_t half = mantissa >> shift;
+                half += (mantissa >> (shift - 1)) & 1;
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            // A rounding carry into the exponent is the expected result.
+            uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+            half += (mantissa >> 12) & 1;
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        float DecodeFloat16(const uint16_t value) {
+            const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+            const uint32_t exponent = (value >> 10) & 0x1F;
+            const uint32_t mantissa = value & 0x3FF;
+
+            if (exponent == 0) {
+                const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+                return sign != 0 ? -magnitude : magnitude;
+            }
+
+            if (exponent == 31) {
+                return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+            }
+
+            return std::bit_cast<float>(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+        }
+
+        template<typename T>
+        void Store(std::byte*& output, const T& value) {
+            std::memcpy(output, &value, sizeof(value));
+            output += sizeof(value);
+        }
+    }
+
+    std::vector<std::byte> VertexQuantizer::Quantize(const std::span<const float> points, const VertexLayout& layout,
+                                                     PositionTransform& transform, QuantizationReport& report) {
+        const size_t componentCount = layout.GetComponentCount();
+        const size_t vertexCount = componentCount != 0 ? points.size() / componentCount : 0;
+
+        // Offset of the position within the vertex components.
+        size_t positionOffset = 0;
+        size_t positionComponentCount = 0;
+        for (const VertexLayoutAttribute& attribute : layout.GetAttributes()) {
+            if (attribute.semantic == VertexSemantic::Position) {
+                positionComponentCount = attribute.componentCount;
+                break;
+            }
+            positionOffset += attribute.componentCount;
+        }
+
+        std::array<float, 3> minimum;
+        std::array<float, 3> maximum;
+        minimum.fill(std::numeric_limits<float>::max());
+        maximum.fill(std::numeric_limits<float>::lowest());
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            for (size_t axis = 0; axis < positionComponentCount; ++axis) {
+                const float value = points[vertex * componentCount + positionOffset + axis];
+                minimum[axis] = std::min(minimum[axis], value);
+                maximum[axis] = std::max(maximum[axis], value);
+            }
+        }
+
+        transform = PositionTransform{};
+        for (size_t axis = 0; axis < positionComponentCount && vertexCount > 0; ++axis) {
+            const float halfExtent = (maximum[axis] - minimum[axis]) * 0.5f;
+            transform.offset[axis] = minimum[axis] + halfExtent;
+            transform.scale[axis] = halfExtent > 0.0f ? halfExtent : 1.0f;
+        }
+
+        std::vector<std::byte> vertexData(vertexCount * layout.GetStride(VertexEncoding::Quantized));
+        std::byte* output = vertexData.data();
+        report = QuantizationReport{};
+
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            const float* input = points.data() + vertex * componentCount;
+
+            for (const VertexLayoutAttribute& attribute : layout.GetAttributes()) {
+                switch (attribute.semantic) {
+                    case VertexSemantic::Position: {
+                        // Snorm16x2 or Snorm16x4, the padding component is left to 0.
+                        for (size_t axis = 0; axis < (attribute.componentCount == 2 ? 2u : 4u); ++axis) {
+                            if (axis >= attribute.componentCount) {
+                                Store(output, int16_t{0});
+                                continue;
+                            }
+
+                            const int16_t encoded = EncodeSnorm16((input[axis] - transform.offset[axis]) /
+                                                                  transform.scale[axis]);
+                            const float decoded = DecodeSnorm16(encoded) * transform.scale[axis] +
+                                                  transform.offset[axis];
+                            report.maxPositionError = std::max(report.maxPositionError,
+                                                               std::abs(decoded - input[axis]));
+                            Store(output, encoded);
+                        }
+                        break;
+                    }
+                    case VertexSemantic::Color: {
+                        // Unorm8x4, opaque when the model has no alpha.
+                        for (size_t channel = 0; channel < 4; ++channel) {
+                            const float value = channel < attribute.componentCount ? input[channel] : 1.0f;
+                            const uint8_t encoded = EncodeUnorm8(value);
+                            report.maxColorError = std::max(report.maxColorError,
+                                                            std::abs(DecodeUnorm8(encoded) - value));
+                            Store(output, encoded);
+                        }
+                        break;
+                    }
+                    case VertexSemantic::Normal: {
+                        // Snorm8x4, the padding component is left to 0.
+                        for (size_t axis = 0; axis < 4; ++axis) {
+                            const float value = axis < 3 ? input[axis] : 0.0f;
+                            const int8_t encoded = EncodeSnorm8(value);
+                            report.maxNormalError = std::max(report.maxNormalError,
+                                                             std::abs(DecodeSnorm8(encoded) - value));
+                            Store(output, encoded);
+                        }
+                        break;
+                    }
+                    case VertexSemantic::TexCoord: {
+                        // Float16x2, UVs aren't necessarily within [0, 1].
+                        for (size_t axis = 0; axis < 2; ++axis) {
+                            const uint16_t encoded = EncodeFloat16(input[axis]);
+                            report.maxTexCoordError = std::max(report.maxTexCoordError,
+                                                               std::abs(DecodeFloat16(encoded) - input[axis]));
+                            Store(output, encoded);
+                        }
+                        break;
+                    }
+                }
+
+                input += attribute.componentCount;
+            }
+        }
+
+        return vertexData;
+    }
+}
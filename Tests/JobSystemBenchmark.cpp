@@ -0,0 +1,102 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+// How ParallelFor scales with the worker count, on a single compute-bound loop and on many small loops where the
+// scheduling cost dominates. Usage: JobSystemBenchmark [max worker count].
+
+#include <WGPURenderer/JobSystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr uint32_t LargeLoopSize = 1 << 22;
+        constexpr uint32_t SmallLoopSize = 1 << 10;
+        constexpr uint32_t SmallLoopCount = 1 << 12;
+        constexpr uint32_t RepeatCount = 5;
+
+        uint64_t Hash(uint64_t value) {
+            for (int i = 0; i < 64; ++i) {
+                value = value * 6364136223846793005ull + 1442695040888963407ull;
+            }
+
+            return value >> 60;
+        }
+
+        void HashLoop(const uint32_t count, const uint32_t grainSize) {
+            std::atomic<uint64_t> sum = 0;
+            JobSystem::ParallelFor(count, grainSize, [&sum](const uint32_t begin, const uint32_t end) {
+                uint64_t rangeSum = 0;
+                for (uint32_t i = begin; i < end; ++i) {
+                    rangeSum += Hash(i);
+                }
+
+                sum.fetch_add(rangeSum, std::memory_order_relaxed);
+            });
+        }
+
+        // Best of a few runs, in milliseconds.
+        template<typename Func>
+        double Measure(Func&& func) {
+            double best = 0.0;
+            for (uint32_t repeat = 0; repeat < RepeatCount; ++repeat) {
+                const auto start = std::chrono::steady_clock::now();
+                func();
+                const double duration =
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                best = repeat == 0 ? duration : std::min(best, duration);
+            }
+
+            return best;
+        }
+    }
+}
+
+int main(const int argc, char** argv) {
+    using namespace WGPURenderer;
+
+    const uint32_t maxWorkerCount = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1]))
+                                             : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    double baseline[2] = {};
+    for (uint32_t workerCount = 0; workerCount <= std::min(maxWorkerCount, JobSystem::MaxWorkerCount);
+         workerCount = std::max(workerCount * 2, workerCount + 1)) {
+        // Without Initialize(), the jobs run on the calling thread, which is the baseline.
+        if (workerCount > 0) {
+            JobSystem::Initialize(workerCount);
+        }
+
+        const double durations[2] = {
+            Measure([] { HashLoop(LargeLoopSize, 1 << 12); }),
+            Measure([] {
+                for (uint32_t i = 0; i < SmallLoopCount; ++i) {
+                    HashLoop(SmallLoopSize, 64);
+                }
+            }),
+        };
+        if (workerCount == 0) {
+            baseline[0] = durations[0];
+            baseline[1] = durations[1];
+        }
+
+        std::cout << JobSystem::GetThreadCount() << " threads: large loop " << durations[0] << " ms (x"
+                  << baseline[0] / durations[0] << "), small loops " << durations[1] << " ms (x"
+                  << baseline[1] / durations[1] << ")\n";
+
+        if (workerCount > 0) {
+            JobSystem::Terminate();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+// Hammers the job system from its own threads and from outside of it. Meant to run under ThreadSanitizer as well,
+// see Tests/xmake.lua.
+
+#include <WGPURenderer/JobSystem.hpp>
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr uint32_t RoundCount = 200;
+        constexpr uint32_t ExternalThreadCount = 3;
+
+        bool Check(const bool condition, const char* what) {
+            if (!condition) {
+                std::cerr << "Check failed: " << what << "!\n";
+            }
+
+            return condition;
+        }
+
+        // Jobs that wait for the jobs they create.
+        bool RunNestedParallelFor() {
+            constexpr uint32_t OuterCount = 50;
+            constexpr uint32_t InnerCount = 100;
+
+            std::vector<uint32_t> values(OuterCount * InnerCount);
+            JobSystem::ParallelFor(OuterCount, 1, [&values](const uint32_t begin, const uint32_t end) {
+                for (uint32_t i = begin; i < end; ++i) {
+                    JobSystem::ParallelFor(InnerCount, 7, [&values, i](const uint32_t innerBegin,
+                                                                       const uint32_t innerEnd) {
+                        for (uint32_t j = innerBegin; j < innerEnd; ++j) {
+                            values[i * InnerCount + j] = i * InnerCount + j + 1;
+                        }
+                    });
+                }
+            });
+
+            for (uint32_t i = 0; i < values.size(); ++i) {
+                if (values[i] != i + 1) {
+                    return Check(false, "nested ParallelFor covers its whole range once");
+                }
+            }
+
+            return true;
+        }
+
+        // The continuation runs once, after every job of the batch.
+        bool RunContinuation() {
+            struct Data {
+                std::atomic<uint32_t> jobCount = 0;
+                uint32_t countSeenByContinuation = 0;
+            } data;
+
+            Job continuation;
+            continuation.function = [](void* data, uint32_t, uint32_t) {
+                auto& batchData = *static_cast<Data*>(data);
+                batchData.countSeenByContinuation += batchData.jobCount.load(std::memory_order_relaxed);
+            };
+            continuation.data = &data;
+
+            JobCounter done;
+            JobCounter batch(continuation, done);
+
+            std::array<Job, 64> jobs;
+            for (Job& job : jobs) {
+                job.function = [](void* data, uint32_t, uint32_t) {
+                    static_cast<Data*>(data)->jobCount.fetch_add(1, std::memory_order_relaxed);
+                };
+                job.data = &data;
+            }
+
+            JobSystem::Run(jobs, batch);
+            JobSystem::Wait(done);
+
+            return Check(data.countSeenByContinuation == jobs.size(), "the continuation runs after its batch");
+        }
+
+        // More jobs than the shared queue holds, from several threads at once.
+        bool RunFromExternalThreads() {
+            std::array<std::future<uint64_t>, ExternalThreadCount> results;
+            for (std::future<uint64_t>& result : results) {
+                result = std::async(std::launch::async, [] {
+                    std::atomic<uint64_t> sum = 0;
+                    JobSystem::ParallelFor(10'000, 1, [&sum](const uint32_t begin, const uint32_t end) {
+                        sum.fetch_add(end - begin, std::memory_order_relaxed);
+                    });
+
+                    std::vector<Job> jobs(JobSystem::DequeCapacity * 2);
+                    for (Job& job : jobs) {
+                        job.function = [](void* data, uint32_t, uint32_t) {
+                            static_cast<std::atomic<uint64_t>*>(data)->fetch_add(1, std::memory_order_relaxed);
+                        };
+                        job.data = &sum;
+                    }
+
+                    JobCounter counter;
+                    JobSystem::Run(jobs, counter);
+                    JobSystem::Wait(counter);
+
+                    return sum.load();
+                });
+            }
+
+            bool success = true;
+            for (std::future<uint64_t>& result : results) {
+                success = Check(result.get() == 10'000 + JobSystem::DequeCapacity * 2,
+                                "external threads run all their jobs") && success;
+            }
+
+            return success;
+        }
+    }
+}
+
+int main(const int argc, char** argv) {
+    using namespace WGPURenderer;
+
+    bool success = true;
+    const uint32_t workerCounts[] = {1, 3, 7, 15};
+    for (const uint32_t workerCount : workerCounts) {
+        if (argc > 1 && std::stoul(argv[1]) != workerCount) {
+            continue;
+        }
+
+        JobSystem::Initialize(workerCount);
+        for (uint32_t round = 0; round < RoundCount && success; ++round) {
+            success = RunNestedParallelFor() && success;
+            success = RunContinuation() && success;
+            success = RunFromExternalThreads() && success;
+        }
+        JobSystem::Terminate();
+
+        std::cout << workerCount << " workers: " << (success ? "passed" : "failed") << '\n';
+    }
+
+    // Without workers, the jobs run on the calling thread.
+    uint32_t inlineCount = 0;
+    JobSystem::ParallelFor(10, 1, [&inlineCount](const uint32_t begin, const uint32_t end) {
+        inlineCount += end - begin;
+    });
+    success = Check(inlineCount == 10, "jobs run inline without workers") && success;
+
+    std::cout << (success ? "Passed\n" : "Failed\n");
+    return success ? 0 : 1;
+}
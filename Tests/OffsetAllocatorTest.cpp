@@ -0,0 +1,177 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+// Allocations must never overlap, freeing everything must give the whole capacity back as a single region, and the
+// statistics must describe the free space as it is.
+
+#include <WGPURenderer/OffsetAllocator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr uint32_t RandomCapacity = 1 << 16;
+        constexpr uint32_t RandomOperationCount = 20'000;
+        constexpr uint32_t MaxRandomSize = 1024;
+
+        bool Check(const bool condition, const char* what) {
+            if (!condition) {
+                std::cerr << "Check failed: " << what << "!\n";
+            }
+
+            return condition;
+        }
+
+        bool IsNear(const float value, const float expected) {
+            return std::abs(value - expected) < 1e-5f;
+        }
+
+        // The allocations are sorted by offset along the way.
+        bool CheckAllocations(const OffsetAllocator& allocator, std::vector<OffsetAllocator::Allocation>& allocations) {
+            std::ranges::sort(allocations, {}, &OffsetAllocator::Allocation::offset);
+
+            uint32_t usedSize = 0;
+            uint32_t end = 0;
+            for (const OffsetAllocator::Allocation& allocation : allocations) {
+                if (!Check(allocation.offset >= end, "allocations don't overlap") ||
+                    !Check(allocation.size <= allocator.GetCapacity() - allocation.offset,
+                           "allocations are inside the capacity")) {
+                    return false;
+                }
+
+                end = allocation.offset + allocation.size;
+                usedSize += allocation.size;
+            }
+
+            const OffsetAllocatorStatistics statistics = allocator.GetStatistics();
+            return Check(statistics.usedSize == usedSize && statistics.freeSize == statistics.capacity - usedSize,
+                         "the used and free sizes add up the allocations") &&
+                   Check(statistics.allocationCount == allocations.size(), "every allocation is counted");
+        }
+
+        bool TestRandomAllocations() {
+            OffsetAllocator allocator;
+            allocator.Reset(RandomCapacity);
+
+            std::mt19937 random(1234);
+            std::uniform_int_distribution<uint32_t> sizeDistribution(1, MaxRandomSize);
+            std::vector<OffsetAllocator::Allocation> allocations;
+
+            bool success = true;
+            for (uint32_t i = 0; i < RandomOperationCount && success; ++i) {
+                // Mostly allocating at first, mostly freeing once the allocator is well filled.
+                const bool allocate =
+                    allocations.empty() || random() % RandomCapacity > allocator.GetStatistics().usedSize;
+                if (allocate) {
+                    OffsetAllocator::Allocation allocation;
+                    if (allocator.Allocate(sizeDistribution(random), allocation)) {
+                        allocations.push_back(allocation);
+                    }
+                } else {
+                    const size_t index = random() % allocations.size();
+                    allocator.Free(allocations[index]);
+                    allocations.erase(allocations.begin() + static_cast<std::ptrdiff_t>(index));
+                }
+
+                success = CheckAllocations(allocator, allocations);
+            }
+
+            // Freed in random order, the regions must merge back into one.
+            std::ranges::shuffle(allocations, random);
+            for (const OffsetAllocator::Allocation& allocation : allocations) {
+                allocator.Free(allocation);
+            }
+
+            const OffsetAllocatorStatistics statistics = allocator.GetStatistics();
+            success = Check(statistics.freeRegionCount == 1 && statistics.largestFreeRegion == RandomCapacity,
+                            "freeing everything merges the free space into a single region") && success;
+
+            OffsetAllocator::Allocation whole;
+            return Check(allocator.Allocate(RandomCapacity, whole) && whole.offset == 0,
+                         "the whole capacity can be allocated again") && success;
+        }
+
+        bool TestGrow() {
+            OffsetAllocator allocator;
+            allocator.Reset(100);
+
+            OffsetAllocator::Allocation first;
+            OffsetAllocator::Allocation allocation;
+            bool success = Check(allocator.Allocate(100, first), "the whole capacity can be allocated");
+            success = Check(!allocator.Allocate(1, allocation), "a full allocator fails to allocate") && success;
+
+            // After a used region, the added space is a new free region.
+            allocator.Grow(200);
+            success = Check(allocator.GetCapacity() == 200, "growing raises the capacity") && success;
+            success = Check(allocator.Allocate(60, allocation) && allocation.offset == 100,
+                            "the added space starts at the previous capacity") && success;
+
+            // After a free region, the added space extends it.
+            allocator.Grow(300);
+            OffsetAllocatorStatistics statistics = allocator.GetStatistics();
+            success = Check(statistics.freeRegionCount == 1 && statistics.largestFreeRegion == 140,
+                            "the added space merges with the free region at the end") && success;
+
+            allocator.Grow(250);
+            success = Check(allocator.GetCapacity() == 300, "growing never shrinks the capacity") && success;
+
+            allocator.Free(first);
+            allocator.Free(allocation);
+            statistics = allocator.GetStatistics();
+            return Check(statistics.freeRegionCount == 1 && statistics.largestFreeRegion == 300,
+                         "the grown space merges with the rest once freed") && success;
+        }
+
+        bool TestStatistics() {
+            OffsetAllocator allocator;
+            allocator.Reset(1000);
+
+            OffsetAllocatorStatistics statistics = allocator.GetStatistics();
+            bool success = Check(IsNear(statistics.GetFragmentation(), 0.0f) && IsNear(statistics.GetOccupancy(), 0.0f),
+                                 "an empty allocator is neither fragmented nor occupied");
+
+            std::vector<OffsetAllocator::Allocation> allocations(10);
+            for (OffsetAllocator::Allocation& allocation : allocations) {
+                success = Check(allocator.Allocate(100, allocation), "the capacity holds 10 allocations") && success;
+            }
+
+            statistics = allocator.GetStatistics();
+            success = Check(statistics.freeRegionCount == 0 && IsNear(statistics.GetFragmentation(), 0.0f) &&
+                            IsNear(statistics.GetOccupancy(), 1.0f), "a full allocator is fully occupied") && success;
+
+            // Every other allocation freed leaves 5 separate free regions of 100.
+            for (size_t i = 1; i < allocations.size(); i += 2) {
+                allocator.Free(allocations[i]);
+            }
+
+            statistics = allocator.GetStatistics();
+            success = Check(statistics.freeRegionCount == 5 && statistics.largestFreeRegion == 100 &&
+                            statistics.freeSize == 500 && statistics.allocationCount == 5,
+                            "the free regions are counted separately") && success;
+            success = Check(IsNear(statistics.GetFragmentation(), 0.8f), "scattered free space is fragmented") &&
+                      success;
+            success = Check(IsNear(statistics.GetOccupancy(), 0.5f), "the occupancy is the used fraction") && success;
+
+            OffsetAllocator::Allocation allocation;
+            success = Check(!allocator.Allocate(101, allocation),
+                            "an allocation larger than every free region fails") && success;
+            return Check(!allocator.Allocate(0, allocation), "an empty allocation fails") && success;
+        }
+    }
+}
+
+int main() {
+    using namespace WGPURenderer;
+
+    bool success = TestRandomAllocations();
+    success = TestGrow() && success;
+    success = TestStatistics() && success;
+
+    std::cout << (success ? "Passed\n" : "Failed\n");
+    return success ? 0 : 1;
+}
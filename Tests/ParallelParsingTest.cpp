@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+// Parsing a model on several threads must give the same output as parsing it on the calling thread, bit for bit.
+
+#include <WGPURenderer/JobSystem.hpp>
+#include <WGPURenderer/ResourceManager.hpp>
+
+#include "SyntheticModel.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        // Enough to be split into several chunks, see MinParseChunkSize.
+        constexpr size_t LargeModelPointCount = 400'000;
+
+        struct ParsedModel {
+            VertexLayout layout;
+            std::vector<float> pointData;
+            std::vector<uint32_t> indexData;
+        };
+
+        bool IsBitwiseEqual(const ParsedModel& lhs, const ParsedModel& rhs) {
+            return lhs.layout == rhs.layout && lhs.pointData.size() == rhs.pointData.size() &&
+                   lhs.indexData.size() == rhs.indexData.size() &&
+                   std::memcmp(lhs.pointData.data(), rhs.pointData.data(), lhs.pointData.size() * sizeof(float)) == 0 &&
+                   std::memcmp(lhs.indexData.data(), rhs.indexData.data(),
+                               lhs.indexData.size() * sizeof(uint32_t)) == 0;
+        }
+
+        bool CompareThreadCounts(const std::filesystem::path& path) {
+            ParsedModel serial;
+            if (!ResourceManager::LoadGeometry(path, serial.layout, serial.pointData, serial.indexData, 1)) {
+                std::cerr << "Couldn't parse " << path << "!\n";
+                return false;
+            }
+
+            bool success = true;
+            for (const unsigned int threadCount : {2u, 3u, 4u, 7u, 16u, 0u}) {
+                ParsedModel parallel;
+                if (!ResourceManager::LoadGeometry(path, parallel.layout, parallel.pointData, parallel.indexData,
+                                                   threadCount)) {
+                    std::cerr << "Couldn't parse " << path << " with " << threadCount << " threads!\n";
+                    success = false;
+                } else if (!IsBitwiseEqual(serial, parallel)) {
+                    std::cerr << "Parsing " << path << " with " << threadCount
+                              << " threads differs from parsing it on a single thread!\n";
+                    success = false;
+                }
+            }
+
+            std::cout << path << ": " << serial.pointData.size() << " floats, " << serial.indexData.size()
+                      << " indices\n";
+            return success;
+        }
+    }
+}
+
+int main() {
+    using namespace WGPURenderer;
+
+    JobSystem::Initialize(3);
+
+    bool success = CompareThreadCounts("webgpu.txt");
+
+    // Absolute, so that it isn't looked up in Resources/Models.
+    const std::filesystem::path largeModelPath =
+        std::filesystem::absolute(std::filesystem::temp_directory_path() / "WGPURendererParallelParsingTest.txt");
+    if (!WriteSyntheticModel(largeModelPath, LargeModelPointCount)) {
+        std::cerr << "Couldn't write " << largeModelPath << "!\n";
+        success = false;
+    } else {
+        success = CompareThreadCounts(largeModelPath) && success;
+    }
+
+    std::error_code error;
+    std::filesystem::remove(largeModelPath, error);
+
+    JobSystem::Terminate();
+
+    std::cout << (success ? "Passed\n" : "Failed\n");
+    return success ? 0 : 1;
+}
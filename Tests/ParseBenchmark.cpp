@@ -0,0 +1,168 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+// Parsing throughput of text models: with the stream based parser LoadGeometry replaced, then with LoadGeometry on the
+// calling thread and on the job system.
+// Usage: ParseBenchmark [model path...], synthetic models of 1M and 10M points are generated when no path is given.
+// Relative paths are looked up in Resources/Models.
+
+#include <WGPURenderer/JobSystem.hpp>
+#include <WGPURenderer/ResourceManager.hpp>
+
+#include "SyntheticModel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace WGPURenderer {
+    namespace {
+        constexpr size_t SyntheticModelPointCounts[] = {1'000'000, 10'000'000};
+        constexpr uint32_t RepeatCount = 5;
+
+        // The parser LoadGeometry used before std::from_chars, kept as the baseline: one istringstream per line and
+        // one push_back per value. It reads 32-bit indices, like LoadGeometry now does, and only the default layout.
+        bool LoadGeometryWithStreams(const std::filesystem::path& path,
+                                     std::vector<float>& pointData,
+                                     std::vector<uint32_t>& indexData) {
+            std::ifstream file(std::filesystem::path("Resources/Models") / path);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            pointData.clear();
+            indexData.clear();
+
+            enum class Section : uint8_t {
+                None,
+                Points,
+                Indices,
+            };
+            auto currentSection = Section::None;
+
+            float value;
+            uint32_t index;
+            std::string line;
+            while (!file.eof()) {
+                getline(file, line);
+
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+
+                if (line == "[points]") {
+                    currentSection = Section::Points;
+                } else if (line == "[indices]") {
+                    currentSection = Section::Indices;
+                } else if (line[0] == '#' || line.empty()) {
+                } else if (currentSection == Section::Points) {
+                    std::istringstream iss(line);
+                    for (int i = 0; i < 5; ++i) {
+                        iss >> value;
+                        pointData.push_back(value);
+                    }
+                } else if (currentSection == Section::Indices) {
+                    std::istringstream iss(line);
+                    for (int i = 0; i < 3; ++i) {
+                        iss >> index;
+                        indexData.push_back(index);
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Best of a few calls of `load`, in MB/s. Returns 0 if the model couldn't be parsed.
+        template<typename Load>
+        double MeasureThroughput(const uint64_t fileSize, const Load& load) {
+            double best = 0.0;
+            for (uint32_t repeat = 0; repeat < RepeatCount; ++repeat) {
+                const auto start = std::chrono::steady_clock::now();
+                if (!load()) {
+                    return 0.0;
+                }
+                const double seconds =
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                best = std::max(best, static_cast<double>(fileSize) / 1e6 / seconds);
+            }
+
+            return best;
+        }
+
+        bool RunBenchmark(const std::filesystem::path& path) {
+            std::error_code error;
+            const uint64_t fileSize = std::filesystem::file_size(std::filesystem::path("Resources/Models") / path,
+                                                                 error);
+            if (error) {
+                std::cerr << "Couldn't find " << path << "!\n";
+                return false;
+            }
+
+            const double streams = MeasureThroughput(fileSize, [&] {
+                std::vector<float> pointData;
+                std::vector<uint32_t> indexData;
+                return LoadGeometryWithStreams(path, pointData, indexData);
+            });
+            const auto measureLoadGeometry = [&](const unsigned int threadCount) {
+                return MeasureThroughput(fileSize, [&] {
+                    VertexLayout layout;
+                    std::vector<float> pointData;
+                    std::vector<uint32_t> indexData;
+                    return ResourceManager::LoadGeometry(path, layout, pointData, indexData, threadCount);
+                });
+            };
+            const double serial = measureLoadGeometry(1);
+            const double parallel = measureLoadGeometry(0);
+            if (streams == 0.0 || serial == 0.0 || parallel == 0.0) {
+                std::cerr << "Couldn't parse " << path << "!\n";
+                return false;
+            }
+
+            std::cout << path << " (" << static_cast<double>(fileSize) / 1e6 << " MB): " << streams
+                      << " MB/s with streams, " << serial << " MB/s serial, " << parallel
+                      << " MB/s on the job system (" << JobSystem::GetThreadCount() << " threads)\n";
+            return true;
+        }
+    }
+}
+
+int main(const int argc, char** argv) {
+    using namespace WGPURenderer;
+
+    JobSystem::Initialize();
+    std::cout << std::fixed << std::setprecision(1);
+
+    bool success = true;
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            success = RunBenchmark(argv[i]) && success;
+        }
+    } else {
+        for (const size_t pointCount : SyntheticModelPointCounts) {
+            // Absolute, so that it isn't looked up in Resources/Models.
+            const std::string fileName = "WGPURendererParseBenchmark" + std::to_string(pointCount) + ".txt";
+            const std::filesystem::path modelPath =
+                std::filesystem::absolute(std::filesystem::temp_directory_path() / fileName);
+            if (!WriteSyntheticModel(modelPath, pointCount)) {
+                std::cerr << "Couldn't write " << modelPath << "!\n";
+                success = false;
+            } else {
+                success = RunBenchmark(modelPath) && success;
+            }
+
+            std::error_code error;
+            std::filesystem::remove(modelPath, error);
+        }
+    }
+
+    JobSystem::Terminate();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+// Handles of destroyed resources must stop resolving right away, while their objects must outlive the frames in
+// flight. Fake objects stand for the GPU ones, so that no device is needed.
+
+#include <WGPURenderer/ResourceRegistry.hpp>
+
+#include <cstddef>
+#include <iostream>
+
+namespace WGPURenderer {
+    namespace {
+        struct FakeObject {
+            uint32_t destroyCount = 0;
+            uint32_t releaseCount = 0;
+        };
+
+        // Like the webgpu.hpp handles: nullable, compared by address, released explicitly.
+        class FakeResource {
+        public:
+            FakeResource() = default;
+            FakeResource(std::nullptr_t) {
+            }
+
+            explicit FakeResource(FakeObject& object)
+                : m_Object(&object) {
+            }
+
+            void destroy() {
+                ++m_Object->destroyCount;
+            }
+
+            void release() {
+                ++m_Object->releaseCount;
+            }
+
+            operator bool() const {
+                return m_Object != nullptr;
+            }
+
+            bool operator==(const FakeResource&) const = default;
+
+        private:
+            FakeObject* m_Object = nullptr;
+        };
+
+        using FakeRegistry = BasicResourceRegistry<FakeResource>;
+
+        bool Check(const bool condition, const char* what) {
+            if (!condition) {
+                std::cerr << "Check failed: " << what << "!\n";
+            }
+
+            return condition;
+        }
+
+        bool TestDeferredRelease() {
+            FakeRegistry registry;
+            registry.BeginFrame(0);
+
+            FakeObject object;
+            const ResourceHandle<FakeResource> handle = registry.Add(FakeResource(object));
+            bool success = Check(static_cast<bool>(handle), "an added resource gets a handle");
+            success = Check(registry.Get(handle) == FakeResource(object), "a handle resolves to its object") &&
+                      success;
+
+            registry.Destroy(handle);
+            success = Check(registry.Get(handle) == nullptr, "a destroyed resource's handle is stale") && success;
+            success = Check(registry.GetPendingDestructionCount() == 1, "the destruction is pending") && success;
+
+            // The frame in flight in slot 0 may still use the object.
+            registry.BeginFrame(1);
+            success = Check(object.releaseCount == 0, "the object outlives the frames in flight") && success;
+
+            registry.BeginFrame(0);
+            success = Check(object.destroyCount == 1 && object.releaseCount == 1,
+                            "the object is destroyed and released once its frame slot is reused") && success;
+            success = Check(registry.GetPendingDestructionCount() == 0, "no destruction is pending") && success;
+
+            registry.Terminate();
+            return Check(object.releaseCount == 1, "a released object isn't released again") && success;
+        }
+
+        bool TestGenerations() {
+            FakeRegistry registry;
+            registry.BeginFrame(0);
+
+            FakeObject firstObject;
+            const ResourceHandle<FakeResource> firstHandle = registry.Add(FakeResource(firstObject));
+            registry.Destroy(firstHandle);
+            registry.BeginFrame(0);
+
+            // The slot of the first object is free again and taken by the second one, under a new generation.
+            FakeObject secondObject;
+            const ResourceHandle<FakeResource> secondHandle = registry.Add(FakeResource(secondObject));
+            bool success = Check(secondHandle != firstHandle, "a reused slot has a new generation");
+            success = Check(registry.Get(firstHandle) == nullptr, "a stale handle doesn't resolve to the slot's new "
+                                                                  "object") && success;
+            success = Check(registry.Get(secondHandle) == FakeResource(secondObject),
+                            "the new handle resolves to the new object") && success;
+
+            // Destroying through the stale handle must leave the new object alone.
+            registry.Destroy(firstHandle);
+            success = Check(registry.GetPendingDestructionCount() == 0, "a stale handle destroys nothing") && success;
+
+            // Past the largest generation, the slot starts over without ever producing a null handle.
+            ResourceHandle<FakeResource> handle = secondHandle;
+            for (uint32_t i = 0; i < 5000 && success; ++i) {
+                registry.Destroy(handle);
+                registry.BeginFrame(0);
+                handle = registry.Add(FakeResource(secondObject));
+                success = Check(static_cast<bool>(handle), "generations wrap around without a null handle") &&
+                          success;
+            }
+
+            registry.Terminate();
+            return success;
+        }
+    }
+}
+
+int main() {
+    using namespace WGPURenderer;
+
+    bool success = TestDeferredRelease();
+    success = TestGenerations() && success;
+
+    std::cout << (success ? "Passed\n" : "Failed\n");
+    return success ? 0 : 1;
+}
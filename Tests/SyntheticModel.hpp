@@ -0,0 +1,37 @@
+// Copyright (C) 2024 Jean "Pixfri" Letessier 
+// This file is part of WGPURenderer.
+// For conditions of distribution and use, see copyright notice in LICENSE.
+
+#pragma once
+
+#ifndef WR_TESTS_SYNTHETICMODEL_HPP
+#define WR_TESTS_SYNTHETICMODEL_HPP
+
+#include <filesystem>
+#include <fstream>
+
+namespace WGPURenderer {
+    // Writes a text model of `pointCount` points in the default layout, forming a triangle list. Values, comments and
+    // blank lines vary, so that the chunks of a parallel parse start on all kinds of lines.
+    inline bool WriteSyntheticModel(const std::filesystem::path& path, const size_t pointCount) {
+        std::ofstream file(path, std::ios::binary);
+        file << "[layout]\nposition 2\ncolor 3\n\n[points]\n";
+        for (size_t i = 0; i < pointCount; ++i) {
+            if (i % 1000 == 0) {
+                file << "# point " << i << "\n\n";
+            }
+
+            file << static_cast<float>(i) * 0.001f << ' ' << -static_cast<float>(i % 977) / 3.0f << "  "
+                 << static_cast<float>(i % 3) / 7.0f << ' ' << (i % 2 != 0 ? "+0.5" : "1e-3") << " 0.25\r\n";
+        }
+
+        file << "\n[indices]\n";
+        for (size_t i = 0; i + 2 < pointCount; i += 3) {
+            file << ' ' << i << ' ' << i + 2 << ' ' << i + 1 << '\n';
+        }
+
+        return static_cast<bool>(file);
+    }
+}
+
+#endif // WR_TESTS_SYNTHETICMODEL_HPP
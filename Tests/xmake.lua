@@ -0,0 +1,101 @@
+-- Tests and benchmarks of the parts of the renderer that run without a GPU. They aren't built by default:
+--   xmake build -g Tests && xmake test
+-- The benchmarks are in the Benchmarks group and print their results, see each target.
+-- They link the sources they exercise rather than the renderer itself, whose entry point is the application.
+
+local geometrySources = {
+  "Geometry.cpp",
+  "GeometryCache.cpp",
+  "MappedFile.cpp",
+  "MeshOptimizer.cpp",
+  "ResourceManager.cpp",
+  "VertexLayout.cpp",
+  "VertexQuantizer.cpp",
+  "WebGPUHppImpl.cpp"
+}
+
+local coreSources = {
+  "FrameArena.cpp",
+  "JobSystem.cpp",
+  "Profiler.cpp"
+}
+
+local function add_renderer_sources(sources)
+  for _, source in ipairs(sources) do
+    add_files(path.join("..", "Source", ProjectName, source))
+  end
+end
+
+target("ParallelParsingTest")
+  set_kind("binary")
+  set_default(false)
+  set_group("Tests")
+
+  add_files("ParallelParsingTest.cpp")
+  add_renderer_sources(coreSources)
+  add_renderer_sources(geometrySources)
+
+  add_includedirs("$(projectdir)/ThirdParty")
+  add_packages("wgpu-native")
+
+  -- The models are looked up in Resources/Models.
+  set_rundir("$(projectdir)")
+  add_tests("default")
+
+target("ResourceRegistryTest")
+  set_kind("binary")
+  set_default(false)
+  set_group("Tests")
+
+  add_files("ResourceRegistryTest.cpp")
+
+  -- Only for the declarations of webgpu.hpp, the test doesn't create any GPU object.
+  add_includedirs("$(projectdir)/ThirdParty")
+  add_packages("wgpu-native")
+
+  add_tests("default")
+
+target("OffsetAllocatorTest")
+  set_kind("binary")
+  set_default(false)
+  set_group("Tests")
+
+  add_files("OffsetAllocatorTest.cpp")
+  add_renderer_sources({"OffsetAllocator.cpp"})
+
+  add_tests("default")
+
+-- Also worth running under ThreadSanitizer: xmake f -m debug --policies=build.sanitizer.thread
+target("JobSystemStressTest")
+  set_kind("binary")
+  set_default(false)
+  set_group("Tests")
+
+  add_files("JobSystemStressTest.cpp")
+  add_renderer_sources(coreSources)
+
+  add_tests("default")
+
+-- xmake run JobSystemBenchmark [max worker count]
+target("JobSystemBenchmark")
+  set_kind("binary")
+  set_default(false)
+  set_group("Benchmarks")
+
+  add_files("JobSystemBenchmark.cpp")
+  add_renderer_sources(coreSources)
+
+-- xmake run ParseBenchmark [model path...]
+target("ParseBenchmark")
+  set_kind("binary")
+  set_default(false)
+  set_group("Benchmarks")
+
+  add_files("ParseBenchmark.cpp")
+  add_renderer_sources(coreSources)
+  add_renderer_sources(geometrySources)
+
+  add_includedirs("$(projectdir)/ThirdParty")
+  add_packages("wgpu-native")
+
+  set_rundir("$(projectdir)")
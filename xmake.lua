@@ -8,6 +8,7 @@ add_rules("mode.debug", "mode.release")
 set_languages("cxx20")
 
 option("override_runtime", {description = "Override VS runtime to MD in release and MDd in debug.", default = true})
+option("profiling", {description = "Record CPU profiling scopes and write a Chrome trace on exit.", default = false})
 
 add_includedirs("Include")
 
@@ -29,6 +30,10 @@ set_rundir("./bin/$(plat)_$(arch)_$(mode)")
 set_targetdir("./bin/$(plat)_$(arch)_$(mode)")
 set_warnings("allextra")
 
+if has_config("profiling") then
+  add_defines("WR_PROFILING")
+end
+
 if is_plat("windows") then
   if has_config("override_runtime") then
     set_runtimes(is_mode("debug") and "MDd" or "MD")
@@ -66,4 +71,5 @@ target(ProjectName)
 
   add_packages("wgpu-native", "glfw", "glfw3webgpu", "magic_enum")
 
+includes("Tests/xmake.lua")
 includes("xmake/**.lua")
\ No newline at end of file